@@ -1,11 +1,25 @@
 #include "PhysicsEngine.hpp"
 
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
 const int unsigned SCREEN_WIDTH = 1080;
 const int unsigned SCREEN_HEIGHT = 720;
 
 int main(int argc, char* argv[])
 {
-    PhysicsEngine physicsEngine("XPBD Softbody Implementation", SCREEN_WIDTH, SCREEN_HEIGHT);
+    // --workers N simulates the dynamic objects in N separate processes
+    int workerProcesses = 0;
+    for (int i = 1; i + 1 < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--workers") == 0)
+        {
+            workerProcesses = std::max(0, std::atoi(argv[i + 1]));
+        }
+    }
+
+    PhysicsEngine physicsEngine("XPBD Softbody Implementation", SCREEN_WIDTH, SCREEN_HEIGHT, workerProcesses);
     while (physicsEngine.isRunning())
     {
         physicsEngine.handleEvents();
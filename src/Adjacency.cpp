@@ -0,0 +1,83 @@
+#include "Adjacency.hpp"
+
+void Adjacency::clear()
+{
+    m_offsets.clear();
+    m_entries.clear();
+    clearOverflow();
+}
+
+void Adjacency::clearOverflow()
+{
+    m_overflowRows.clear();
+    m_overflow.clear();
+}
+
+std::vector<unsigned int>& Adjacency::editRow(size_t r)
+{
+    if (m_overflowRows.empty())
+    {
+        m_overflowRows.assign(getNumRows(), -1);
+    }
+
+    // the row's current entries are copied out on its first edit
+    if (m_overflowRows[r] < 0)
+    {
+        m_overflowRows[r] = static_cast<int>(m_overflow.size());
+        m_overflow.emplace_back(m_entries.begin() + m_offsets[r], m_entries.begin() + m_offsets[r + 1]);
+    }
+    return m_overflow[m_overflowRows[r]];
+}
+
+void Adjacency::appendRow()
+{
+    if (m_offsets.empty()) m_offsets.push_back(0);
+    m_offsets.push_back(m_offsets.back());
+    if (!m_overflowRows.empty()) m_overflowRows.push_back(-1);
+}
+
+void Adjacency::insert(size_t r, unsigned int entry)
+{
+    editRow(r).push_back(entry);
+}
+
+void Adjacency::erase(size_t r, unsigned int entry)
+{
+    std::erase(editRow(r), entry);
+}
+
+void Adjacency::replace(size_t r, unsigned int from, unsigned int to)
+{
+    std::vector<unsigned int>& row = editRow(r);
+    std::replace(row.begin(), row.end(), from, to);
+}
+
+void Adjacency::compact()
+{
+    if (m_overflow.empty()) return;
+
+    size_t numRows = getNumRows();
+    std::vector<unsigned int> offsets(numRows + 1, 0);
+    std::vector<unsigned int> entries;
+    entries.reserve(m_entries.size());
+    for (size_t r = 0; r < numRows; ++r)
+    {
+        std::span<const unsigned int> row = (*this)[r];
+        entries.insert(entries.end(), row.begin(), row.end());
+        offsets[r + 1] = static_cast<unsigned int>(entries.size());
+    }
+
+    m_offsets = std::move(offsets);
+    m_entries = std::move(entries);
+    clearOverflow();
+}
+
+void Adjacency::buildInverse(size_t numRows, const std::vector<unsigned int>& rows)
+{
+    build(numRows, [&rows](auto emit) {
+        for (size_t i = 0; i < rows.size(); ++i)
+        {
+            emit(rows[i], static_cast<unsigned int>(i));
+        }
+    });
+}
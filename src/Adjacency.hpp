@@ -0,0 +1,122 @@
+#pragma once
+
+#include <algorithm>
+#include <span>
+#include <vector>
+
+// One-to-many topology in compressed sparse rows: the entries of row r are
+// m_entries[m_offsets[r] .. m_offsets[r + 1]). Rows are built in one go by a
+// counting sort, or gathered in parallel, and are read as contiguous ranges
+// instead of one heap block per row. Rows edited in place move whole into an
+// overflow list until the next compact(), so every row stays contiguous.
+class Adjacency
+{
+public:
+    size_t getNumRows() const { return m_offsets.empty() ? 0 : m_offsets.size() - 1; }
+    size_t getNumEntries() const { return m_entries.size(); }   // as of the last compaction
+    bool empty() const { return m_entries.empty(); }
+
+    std::span<const unsigned int> operator[](size_t r) const
+    {
+        if (!m_overflowRows.empty() && m_overflowRows[r] >= 0)
+        {
+            return m_overflow[m_overflowRows[r]];
+        }
+        return { m_entries.data() + m_offsets[r], m_entries.data() + m_offsets[r + 1] };
+    }
+
+    void clear();
+
+    // in-place edits; spans of the edited row are invalidated
+    void appendRow();
+    void insert(size_t r, unsigned int entry);
+    void erase(size_t r, unsigned int entry);
+    void replace(size_t r, unsigned int from, unsigned int to);
+
+    // folds the overflow back into the flat arrays in one pass
+    void compact();
+
+    // row r holds every i with rows[i] == r, in increasing order
+    void buildInverse(size_t numRows, const std::vector<unsigned int>& rows);
+
+    // forEachEntry(emit) calls emit(row, entry) for every entry, in the same
+    // order both times it is run: once to count the rows, once to fill them.
+    // Entries keep that order within their row
+    template<typename ForEachEntry>
+    void build(size_t numRows, ForEachEntry forEachEntry);
+
+    // gatherRow(r, out) appends the entries of row r to out; rows are gathered
+    // in parallel, and the result does not depend on the number of threads
+    template<typename GatherRow>
+    void gather(size_t numRows, GatherRow gatherRow);
+
+private:
+    std::vector<unsigned int>& editRow(size_t r);
+    void clearOverflow();
+
+private:
+    std::vector<unsigned int> m_offsets;
+    std::vector<unsigned int> m_entries;
+
+    // per row, its slot in m_overflow or -1; empty while nothing is edited
+    std::vector<int> m_overflowRows;
+    std::vector<std::vector<unsigned int>> m_overflow;
+};
+
+template<typename ForEachEntry>
+void Adjacency::build(size_t numRows, ForEachEntry forEachEntry)
+{
+    clearOverflow();
+    m_offsets.assign(numRows + 1, 0);
+    forEachEntry([this](unsigned int row, unsigned int) { m_offsets[row + 1]++; });
+
+    for (size_t r = 0; r < numRows; ++r)
+    {
+        m_offsets[r + 1] += m_offsets[r];
+    }
+
+    // each row's next free slot, starting at its offset
+    std::vector<unsigned int> next(m_offsets.begin(), m_offsets.end() - 1);
+    m_entries.resize(m_offsets[numRows]);
+    forEachEntry([this, &next](unsigned int row, unsigned int entry) { m_entries[next[row]++] = entry; });
+}
+
+template<typename GatherRow>
+void Adjacency::gather(size_t numRows, GatherRow gatherRow)
+{
+    const long long n = static_cast<long long>(numRows);
+
+    // each thread gathers one contiguous range of rows into its own list, which
+    // is copied into place after the prefix sum
+    clearOverflow();
+    m_offsets.assign(numRows + 1, 0);
+    #pragma omp parallel
+    {
+        std::vector<unsigned int> local;
+        long long first = -1;
+
+        #pragma omp for schedule(static)
+        for (long long r = 0; r < n; ++r)
+        {
+            if (first < 0) first = r;
+
+            size_t start = local.size();
+            gatherRow(static_cast<size_t>(r), local);
+            m_offsets[r + 1] = static_cast<unsigned int>(local.size() - start);
+        }
+
+        #pragma omp single
+        {
+            for (long long r = 0; r < n; ++r)
+            {
+                m_offsets[r + 1] += m_offsets[r];
+            }
+            m_entries.resize(m_offsets[n]);
+        }
+
+        if (first >= 0)
+        {
+            std::copy(local.begin(), local.end(), m_entries.begin() + m_offsets[first]);
+        }
+    }
+}
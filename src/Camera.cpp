@@ -84,6 +84,18 @@ void cursorPosCallback(GLFWwindow* window, double xpos, double ypos)
     camera->updateOrbit();
 }
 
+glm::vec3 Camera::getPickDirection(float x, float y, float width, float height) const
+{
+    float ndcX = 2.0f * x / width - 1.0f;
+    float ndcY = 1.0f - 2.0f * y / height;
+    float tanHalfFOV = std::tan(0.5f * glm::radians(m_FOV));
+
+    glm::vec3 front = glm::normalize(m_cameraFront);
+    glm::vec3 right = glm::normalize(glm::cross(front, m_cameraUp));
+    glm::vec3 up = glm::cross(right, front);
+    return glm::normalize(front + tanHalfFOV * (ndcX * m_aspectRatio * right + ndcY * up));
+}
+
 void Camera::resetPosition()
 {
     m_cameraPos = m_originalCameraPos;
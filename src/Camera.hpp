@@ -32,6 +32,9 @@ public:
     float getNearPlane()           const { return m_nearPlane; }
     float getFarPlane()            const { return m_farPlane; }
 
+    // unit direction of the ray through a window point, in pixels from the top left
+    glm::vec3 getPickDirection(float x, float y, float width, float height) const;
+
     void setPosition(const glm::vec3& position) { m_cameraPos = position; }
     void setDeltaTime(float deltaTime) { m_deltaTime = deltaTime; }
 
@@ -0,0 +1,356 @@
+#include "Cloth.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+
+Cloth::Cloth(
+    std::string name,
+    Transform transform,
+    Shader shader,
+    int numX,
+    int numZ,
+    float width,
+    float height,
+    float mass
+)
+    :   m_name(std::move(name)),
+        m_transform(transform),
+        m_shader(shader),
+        m_numX(std::max(numX, 2)),
+        m_numZ(std::max(numZ, 2)),
+        m_spacing(width / static_cast<float>(m_numX - 1), height / static_cast<float>(m_numZ - 1)),
+        m_thickness(0.1f),
+        m_solverIterations(4),
+        m_stretchCompliance(0.0f),
+        m_shearCompliance(0.0001f),
+        m_VAO(0),
+        m_VBO(0),
+        m_EBO(0),
+        m_numIndices(0)
+{
+    size_t n = static_cast<size_t>(m_numX) * m_numZ;
+    glm::mat4 model = m_transform.getModelMatrix();
+    m_initialPositions.reserve(n);
+    for (int k = 0; k < m_numZ; ++k)
+    {
+        for (int i = 0; i < m_numX; ++i)
+        {
+            glm::vec3 local(
+                -0.5f * width + static_cast<float>(i) * m_spacing.x,
+                0.0f,
+                -0.5f * height + static_cast<float>(k) * m_spacing.y
+            );
+            m_initialPositions.push_back(glm::vec3(model * glm::vec4(local, 1.0f)));
+        }
+    }
+
+    m_w.assign(n, static_cast<float>(n) / mass);
+    reset();
+    setupMesh();
+}
+
+Cloth::~Cloth()
+{
+    glDeleteVertexArrays(1, &m_VAO);
+    glDeleteBuffers(1, &m_VBO);
+    glDeleteBuffers(1, &m_EBO);
+}
+
+void Cloth::pin(int i, int k)
+{
+    if (i < 0 || i >= m_numX || k < 0 || k >= m_numZ)
+    {
+        std::cerr << "Cloth " << m_name << ": no particle (" << i << ", " << k << ") to pin" << std::endl;
+        return;
+    }
+    m_w[static_cast<size_t>(k) * m_numX + i] = 0.0f;
+}
+
+void Cloth::reset()
+{
+    size_t n = m_initialPositions.size();
+    for (int c = 0; c < 3; ++c)
+    {
+        m_x[c].resize(n);
+        m_p[c].resize(n);
+        m_v[c].assign(n, 0.0f);
+        m_posDiff[c].assign(n, 0.0f);
+        for (size_t i = 0; i < n; ++i)
+        {
+            m_x[c][i] = m_initialPositions[i][c];
+            m_p[c][i] = m_initialPositions[i][c];
+        }
+    }
+}
+
+void Cloth::predict(float deltaTime_s, const glm::vec3& gravitationalAcceleration)
+{
+    const long long n = static_cast<long long>(m_w.size());
+    for (int c = 0; c < 3; ++c)
+    {
+        float* __restrict x = m_x[c].data();
+        float* __restrict p = m_p[c].data();
+        float* __restrict v = m_v[c].data();
+        float* __restrict posDiff = m_posDiff[c].data();
+        const float* __restrict w = m_w.data();
+        const float g = gravitationalAcceleration[c];
+
+        // pinned particles have no inverse mass and stay put
+        #pragma omp parallel for simd schedule(static)
+        for (long long i = 0; i < n; ++i)
+        {
+            v[i] = w[i] > 0.0f ? v[i] + deltaTime_s * g : 0.0f;
+            p[i] = x[i];
+            x[i] += deltaTime_s * v[i];
+            posDiff[i] = x[i] - p[i];
+        }
+    }
+}
+
+template<Cloth::Direction D>
+void Cloth::solveBatch(int parity, float restLength, float alphaTilde, float gamma)
+{
+    // row constraints alternate along each row, the others alternate rows
+    constexpr bool alongRow = D == Direction::Row;
+    constexpr size_t step = alongRow ? 2 : 1;
+
+    const size_t numX = static_cast<size_t>(m_numX);
+    const size_t offset = D == Direction::Row ? 1
+                        : D == Direction::Column ? numX
+                        : D == Direction::Diagonal ? numX + 1
+                        : numX - 1;
+    const size_t first = alongRow ? static_cast<size_t>(parity) : (D == Direction::AntiDiagonal ? 1 : 0);
+    const size_t count = alongRow ? (numX - static_cast<size_t>(parity)) / 2
+                       : D == Direction::Column ? numX
+                       : numX - 1;
+    const int numRows = alongRow ? m_numZ : (m_numZ - parity) / 2;
+
+    float* __restrict xx = m_x[0].data();
+    float* __restrict xy = m_x[1].data();
+    float* __restrict xz = m_x[2].data();
+    const float* __restrict dx = m_posDiff[0].data();
+    const float* __restrict dy = m_posDiff[1].data();
+    const float* __restrict dz = m_posDiff[2].data();
+    const float* __restrict w = m_w.data();
+
+    #pragma omp parallel for schedule(static)
+    for (int row = 0; row < numRows; ++row)
+    {
+        size_t k = alongRow ? static_cast<size_t>(row) : static_cast<size_t>(parity + 2 * row);
+        size_t begin = k * numX + first;
+
+        #pragma omp simd
+        for (size_t c = 0; c < count; ++c)
+        {
+            const size_t a = begin + c * step;
+            const size_t b = a + offset;
+
+            float ex = xx[a] - xx[b];
+            float ey = xy[a] - xy[b];
+            float ez = xz[a] - xz[b];
+            float length = std::sqrt(ex * ex + ey * ey + ez * ez);
+            float invLength = length > 0.0f ? 1.0f / length : 0.0f;
+            float nx = ex * invLength;
+            float ny = ey * invLength;
+            float nz = ez * invLength;
+
+            float C_j = length - restLength;
+            float wa = w[a];
+            float wb = w[b];
+            float wSum = wa + wb;
+
+            float gradCPosDiff = nx * (dx[a] - dx[b])
+                               + ny * (dy[a] - dy[b])
+                               + nz * (dz[a] - dz[b]);
+            float deltaLambda = wSum > 0.0f
+                ? (-C_j - gamma * gradCPosDiff) / ((1 + gamma) * wSum + alphaTilde)
+                : 0.0f;
+
+            xx[a] += deltaLambda * wa * nx;
+            xy[a] += deltaLambda * wa * ny;
+            xz[a] += deltaLambda * wa * nz;
+            xx[b] -= deltaLambda * wb * nx;
+            xy[b] -= deltaLambda * wb * ny;
+            xz[b] -= deltaLambda * wb * nz;
+        }
+    }
+}
+
+void Cloth::solveConstraints(float deltaTime_s, float beta)
+{
+    float betaTilde = (deltaTime_s * deltaTime_s) * beta;
+
+    float stretchAlphaTilde = m_stretchCompliance / (deltaTime_s * deltaTime_s);
+    float stretchGamma = (stretchAlphaTilde * betaTilde) / deltaTime_s;
+    float shearAlphaTilde = m_shearCompliance / (deltaTime_s * deltaTime_s);
+    float shearGamma = (shearAlphaTilde * betaTilde) / deltaTime_s;
+    float diagonal = glm::length(m_spacing);
+
+    // within a batch no two constraints share a particle
+    for (int parity = 0; parity < 2; ++parity)
+    {
+        solveBatch<Direction::Row>(parity, m_spacing.x, stretchAlphaTilde, stretchGamma);
+    }
+    for (int parity = 0; parity < 2; ++parity)
+    {
+        solveBatch<Direction::Column>(parity, m_spacing.y, stretchAlphaTilde, stretchGamma);
+    }
+    for (int parity = 0; parity < 2; ++parity)
+    {
+        solveBatch<Direction::Diagonal>(parity, diagonal, shearAlphaTilde, shearGamma);
+    }
+    for (int parity = 0; parity < 2; ++parity)
+    {
+        solveBatch<Direction::AntiDiagonal>(parity, diagonal, shearAlphaTilde, shearGamma);
+    }
+}
+
+void Cloth::gatherPositions(std::vector<glm::vec3>& x) const
+{
+    const long long n = static_cast<long long>(m_w.size());
+    x.resize(n);
+
+    #pragma omp parallel for schedule(static)
+    for (long long i = 0; i < n; ++i)
+    {
+        x[i] = glm::vec3(m_x[0][i], m_x[1][i], m_x[2][i]);
+    }
+}
+
+void Cloth::scatterPositions(const std::vector<glm::vec3>& x)
+{
+    const long long n = static_cast<long long>(m_w.size());
+
+    // collisions must not move pinned particles
+    #pragma omp parallel for schedule(static)
+    for (long long i = 0; i < n; ++i)
+    {
+        if (m_w[i] == 0.0f) continue;
+
+        m_x[0][i] = x[i].x;
+        m_x[1][i] = x[i].y;
+        m_x[2][i] = x[i].z;
+    }
+}
+
+void Cloth::updateVelocities(float deltaTime_s)
+{
+    const long long n = static_cast<long long>(m_w.size());
+    for (int c = 0; c < 3; ++c)
+    {
+        const float* __restrict x = m_x[c].data();
+        const float* __restrict p = m_p[c].data();
+        float* __restrict v = m_v[c].data();
+
+        #pragma omp parallel for simd schedule(static)
+        for (long long i = 0; i < n; ++i)
+        {
+            v[i] = (x[i] - p[i]) / deltaTime_s;
+        }
+    }
+}
+
+void Cloth::setupMesh()
+{
+    // two counter-clockwise triangles per cell, seen from the model's +y
+    std::vector<unsigned int> indices;
+    indices.reserve(static_cast<size_t>(m_numX - 1) * (m_numZ - 1) * 6);
+    for (int k = 0; k + 1 < m_numZ; ++k)
+    {
+        for (int i = 0; i + 1 < m_numX; ++i)
+        {
+            unsigned int i00 = static_cast<unsigned int>(k * m_numX + i);
+            unsigned int i10 = i00 + 1;
+            unsigned int i01 = i00 + static_cast<unsigned int>(m_numX);
+            unsigned int i11 = i01 + 1;
+
+            indices.insert(indices.end(), { i00, i01, i10, i10, i01, i11 });
+        }
+    }
+    m_numIndices = static_cast<GLsizei>(indices.size());
+
+    glGenVertexArrays(1, &m_VAO);
+    glGenBuffers(1, &m_VBO);
+    glGenBuffers(1, &m_EBO);
+
+    glBindVertexArray(m_VAO);
+
+    // positions change every frame, the topology never does
+    glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
+    glBufferData(GL_ARRAY_BUFFER, 2 * m_w.size() * sizeof(glm::vec3), nullptr, GL_DYNAMIC_DRAW);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 2 * sizeof(glm::vec3), (void*)0);
+
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 2 * sizeof(glm::vec3), (void*)sizeof(glm::vec3));
+
+    glBindVertexArray(0);
+}
+
+void Cloth::uploadMesh()
+{
+    m_vertices.resize(2 * m_w.size());
+
+    #pragma omp parallel for schedule(static)
+    for (int k = 0; k < m_numZ; ++k)
+    {
+        for (int i = 0; i < m_numX; ++i)
+        {
+            // central differences, one-sided at the border
+            int i0 = std::max(i - 1, 0);
+            int i1 = std::min(i + 1, m_numX - 1);
+            int k0 = std::max(k - 1, 0);
+            int k1 = std::min(k + 1, m_numZ - 1);
+            glm::vec3 alongX = getPosition(static_cast<size_t>(k) * m_numX + i1) - getPosition(static_cast<size_t>(k) * m_numX + i0);
+            glm::vec3 alongZ = getPosition(static_cast<size_t>(k1) * m_numX + i) - getPosition(static_cast<size_t>(k0) * m_numX + i);
+            glm::vec3 normal = glm::cross(alongZ, alongX);
+            float length = glm::length(normal);
+
+            size_t index = static_cast<size_t>(k) * m_numX + i;
+            m_vertices[2 * index] = getPosition(index);
+            m_vertices[2 * index + 1] = length > 1e-12f ? normal / length : glm::vec3(0.0f, 1.0f, 0.0f);
+        }
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, m_vertices.size() * sizeof(glm::vec3), m_vertices.data());
+}
+
+void Cloth::render()
+{
+    uploadMesh();
+
+    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+
+    glm::vec3 lightDirection = glm::vec3(
+        1.0f,
+        0.5f,
+        0.0
+    );
+
+    m_shader.useProgram();
+    m_shader.setVec3("lightDir", lightDirection);
+
+    int projectionLoc = glGetUniformLocation(m_shader.getID(), "projection");
+    glUniformMatrix4fv(projectionLoc, 1, GL_FALSE, glm::value_ptr(m_transform.getProjectionMatrix()));
+
+    int viewLoc = glGetUniformLocation(m_shader.getID(), "view");
+    glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(m_transform.getViewMatrix()));
+
+    // particles are simulated in world space
+    int modelLoc = glGetUniformLocation(m_shader.getID(), "model");
+    glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(glm::mat4(1.0f)));
+
+    // both sides of the cloth are visible
+    glDisable(GL_CULL_FACE);
+    glBindVertexArray(m_VAO);
+    glDrawElements(GL_TRIANGLES, m_numIndices, GL_UNSIGNED_INT, 0);
+    glBindVertexArray(0);
+    glEnable(GL_CULL_FACE);
+}
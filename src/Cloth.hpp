@@ -0,0 +1,98 @@
+#pragma once
+
+#include <array>
+#include <string>
+#include <vector>
+#include <glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include "Transform.hpp"
+#include "Shader.hpp"
+
+// Cloth on a regular numX * numZ particle grid. Structural and shear distance
+// constraints connect grid neighbours, so they split into eight fixed batches
+// (four directions, alternating rows or columns) whose constraints share no
+// particles. Each batch is solved in parallel over rows, and along a row the
+// kernel runs over contiguous coordinate arrays without any index lists.
+class Cloth
+{
+public:
+    // particles span width * height in the model's xz-plane, centred on its origin
+    Cloth(
+        std::string name,
+        Transform transform,
+        Shader shader,
+        int numX,
+        int numZ,
+        float width,
+        float height,
+        float mass
+    );
+    ~Cloth();
+
+    Cloth(const Cloth&) = delete;
+    Cloth& operator=(const Cloth&) = delete;
+
+    // pinned particles keep their initial position
+    void pin(int i, int k);
+    void reset();
+
+    std::string getName() const { return m_name; }
+    Transform& getTransform() { return m_transform; }
+    size_t getNumParticles() const { return m_w.size(); }
+    float getThickness() const { return m_thickness; }
+    glm::vec3 getPosition(size_t i) const { return glm::vec3(m_x[0][i], m_x[1][i], m_x[2][i]); }
+
+    int& getSolverIterations() { return m_solverIterations; }
+    float& getStretchCompliance() { return m_stretchCompliance; }
+    float& getShearCompliance() { return m_shearCompliance; }
+
+    // one substep: predict, then per iteration solve every batch once and let
+    // the caller resolve collisions on the gathered positions, then update
+    // velocities
+    void predict(float deltaTime_s, const glm::vec3& gravitationalAcceleration);
+    void solveConstraints(float deltaTime_s, float beta);
+    void gatherPositions(std::vector<glm::vec3>& x) const;
+    void scatterPositions(const std::vector<glm::vec3>& x);
+    void updateVelocities(float deltaTime_s);
+
+    void render();
+
+private:
+    // constraint from particle (i, k) to (i + 1, k), (i, k + 1), (i + 1, k + 1)
+    // or (i - 1, k + 1)
+    enum class Direction { Row, Column, Diagonal, AntiDiagonal };
+
+    template<Direction D>
+    void solveBatch(int parity, float restLength, float alphaTilde, float gamma);
+
+    void setupMesh();
+    void uploadMesh();
+
+    std::string m_name;
+    Transform m_transform;
+    Shader m_shader;
+
+    int m_numX;
+    int m_numZ;
+    glm::vec2 m_spacing;
+    float m_thickness;
+    int m_solverIterations;
+    float m_stretchCompliance;
+    float m_shearCompliance;
+
+    // coordinates in separate arrays, row by row along x
+    std::array<std::vector<float>, 3> m_x;
+    std::array<std::vector<float>, 3> m_p;
+    std::array<std::vector<float>, 3> m_v;
+    std::array<std::vector<float>, 3> m_posDiff;
+    std::vector<float> m_w;
+    std::vector<glm::vec3> m_initialPositions;
+
+    GLuint m_VAO;
+    GLuint m_VBO;
+    GLuint m_EBO;
+    GLsizei m_numIndices;
+    std::vector<glm::vec3> m_vertices;   // position and normal, interleaved
+};
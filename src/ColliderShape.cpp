@@ -0,0 +1,207 @@
+#include "ColliderShape.hpp"
+
+#include <algorithm>
+
+ColliderShape ColliderShape::makeBox(const glm::mat4& model, const glm::vec3& localCentre, const glm::vec3& localHalfExtents)
+{
+    ColliderShape shape;
+    shape.m_type = Type::Box;
+    glm::vec3 scale(glm::length(glm::vec3(model[0])), glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2])));
+    shape.m_axes = glm::mat3(
+        glm::vec3(model[0]) / scale.x,
+        glm::vec3(model[1]) / scale.y,
+        glm::vec3(model[2]) / scale.z
+    );
+    shape.m_centre = glm::vec3(model * glm::vec4(localCentre, 1.0f));
+    shape.m_halfExtents = scale * localHalfExtents;
+    return shape;
+}
+
+ColliderShape ColliderShape::makePlane(const glm::vec3& normal, const glm::vec3& point)
+{
+    ColliderShape shape;
+    shape.m_type = Type::Plane;
+    shape.m_axes[1] = glm::normalize(normal);
+    shape.m_radius = glm::dot(shape.m_axes[1], point);
+    return shape;
+}
+
+ColliderShape ColliderShape::makeSphere(const glm::vec3& centre, float radius)
+{
+    ColliderShape shape;
+    shape.m_type = Type::Sphere;
+    shape.m_centre = centre;
+    shape.m_radius = radius;
+    return shape;
+}
+
+ColliderShape ColliderShape::makeCapsule(const glm::vec3& a, const glm::vec3& b, float radius)
+{
+    ColliderShape shape;
+    shape.m_type = Type::Capsule;
+    shape.m_centre = a;
+    shape.m_segment = b - a;
+    shape.m_radius = radius;
+    return shape;
+}
+
+std::optional<ColliderShape> ColliderShape::detect(const std::vector<glm::vec3>& localPositions, const glm::mat4& model)
+{
+    if (localPositions.size() < 4) return std::nullopt;
+
+    glm::vec3 min(std::numeric_limits<float>::max());
+    glm::vec3 max(-std::numeric_limits<float>::max());
+    for (const auto& p : localPositions)
+    {
+        min = glm::min(min, p);
+        max = glm::max(max, p);
+    }
+    glm::vec3 centre = 0.5f * (min + max);
+    glm::vec3 halfExtents = 0.5f * (max - min);
+    float eps = 1e-4f * std::max({ halfExtents.x, halfExtents.y, halfExtents.z });
+    if (halfExtents.x <= eps || halfExtents.y <= eps || halfExtents.z <= eps) return std::nullopt;
+
+    // the axes must stay orthogonal for either shape to survive the transform
+    glm::vec3 c0(model[0]), c1(model[1]), c2(model[2]);
+    float orthoEps = 1e-4f * glm::length(c0) * glm::length(c1) * glm::length(c2);
+    if (std::abs(glm::dot(c0, c1)) > orthoEps ||
+        std::abs(glm::dot(c1, c2)) > orthoEps ||
+        std::abs(glm::dot(c2, c0)) > orthoEps)
+    {
+        return std::nullopt;
+    }
+
+    // box: every vertex is a corner of the bounds and every corner is used
+    unsigned int corners = 0;
+    bool isBox = true;
+    for (const auto& p : localPositions)
+    {
+        glm::bvec3 atMin = glm::lessThanEqual(glm::abs(p - min), glm::vec3(eps));
+        glm::bvec3 atMax = glm::lessThanEqual(glm::abs(p - max), glm::vec3(eps));
+        if (!glm::all(glm::bvec3(atMin.x || atMax.x, atMin.y || atMax.y, atMin.z || atMax.z)))
+        {
+            isBox = false;
+            break;
+        }
+        corners |= 1u << ((atMax.x ? 1 : 0) | (atMax.y ? 2 : 0) | (atMax.z ? 4 : 0));
+    }
+    if (isBox && corners == 0xffu)
+    {
+        return makeBox(model, centre, halfExtents);
+    }
+
+    // sphere: every vertex at the same distance from the centre, under a
+    // uniform scale
+    float radius = std::max({ halfExtents.x, halfExtents.y, halfExtents.z });
+    for (const auto& p : localPositions)
+    {
+        if (std::abs(glm::length(p - centre) - radius) > 1e-3f * radius) return std::nullopt;
+    }
+    float scale = glm::length(c0);
+    if (std::abs(glm::length(c1) - scale) > 1e-4f * scale ||
+        std::abs(glm::length(c2) - scale) > 1e-4f * scale)
+    {
+        return std::nullopt;
+    }
+    return makeSphere(glm::vec3(model * glm::vec4(centre, 1.0f)), scale * radius);
+}
+
+bool ColliderShape::findContact(const glm::vec3& p, glm::vec3& normal, float& depth) const
+{
+    switch (m_type)
+    {
+    case Type::Box:
+    {
+        glm::vec3 q = glm::transpose(m_axes) * (p - m_centre);
+        glm::vec3 d = glm::abs(q) - m_halfExtents;
+        int axis = d.x > d.y ? (d.x > d.z ? 0 : 2) : (d.y > d.z ? 1 : 2);
+        depth = -d[axis];
+        normal = m_axes[axis] * (q[axis] < 0.0f ? -1.0f : 1.0f);
+        break;
+    }
+    case Type::Plane:
+        depth = m_radius - glm::dot(m_axes[1], p);
+        normal = m_axes[1];
+        break;
+    case Type::Sphere:
+    case Type::Capsule:
+    {
+        float segmentLength2 = glm::dot(m_segment, m_segment);
+        float t = segmentLength2 > 0.0f ? glm::clamp(glm::dot(p - m_centre, m_segment) / segmentLength2, 0.0f, 1.0f) : 0.0f;
+        glm::vec3 v = p - (m_centre + t * m_segment);
+        float length = glm::length(v);
+        if (length < 1e-6f) return false;
+        depth = m_radius - length;
+        normal = v / length;
+        break;
+    }
+    }
+    return depth > 0.0f;
+}
+
+void ColliderShape::findContacts(
+    const std::vector<glm::vec3>& x,
+    std::vector<float>& depth,
+    std::vector<glm::vec3>& normal
+) const
+{
+    size_t n = x.size();
+    depth.resize(n);
+    normal.resize(n);
+
+    // one branch-free loop per shape type
+    switch (m_type)
+    {
+    case Type::Box:
+    {
+        const glm::mat3 axesT = glm::transpose(m_axes);
+        #pragma omp simd
+        for (size_t i = 0; i < n; ++i)
+        {
+            glm::vec3 q = axesT * (x[i] - m_centre);
+            glm::vec3 d = glm::abs(q) - m_halfExtents;
+
+            // least penetrated face, selected without branches
+            float dMax = std::max(d.x, std::max(d.y, d.z));
+            glm::vec3 pick(d.x == dMax ? 1.0f : 0.0f, 0.0f, 0.0f);
+            pick.y = (pick.x == 0.0f && d.y == dMax) ? 1.0f : 0.0f;
+            pick.z = 1.0f - pick.x - pick.y;
+            glm::vec3 sign(q.x < 0.0f ? -1.0f : 1.0f, q.y < 0.0f ? -1.0f : 1.0f, q.z < 0.0f ? -1.0f : 1.0f);
+
+            depth[i] = -dMax;
+            normal[i] = m_axes * (pick * sign);
+        }
+        break;
+    }
+    case Type::Plane:
+    {
+        const glm::vec3 planeNormal = m_axes[1];
+        #pragma omp simd
+        for (size_t i = 0; i < n; ++i)
+        {
+            depth[i] = m_radius - glm::dot(planeNormal, x[i]);
+            normal[i] = planeNormal;
+        }
+        break;
+    }
+    case Type::Sphere:
+    case Type::Capsule:
+    {
+        float segmentLength2 = glm::dot(m_segment, m_segment);
+        float invSegmentLength2 = segmentLength2 > 0.0f ? 1.0f / segmentLength2 : 0.0f;
+        #pragma omp simd
+        for (size_t i = 0; i < n; ++i)
+        {
+            float t = glm::clamp(glm::dot(x[i] - m_centre, m_segment) * invSegmentLength2, 0.0f, 1.0f);
+            glm::vec3 v = x[i] - (m_centre + t * m_segment);
+            float length = glm::length(v);
+            float invLength = length > 1e-6f ? 1.0f / length : 0.0f;
+
+            // a particle exactly on the axis has no direction and is skipped
+            depth[i] = length > 1e-6f ? m_radius - length : 0.0f;
+            normal[i] = v * invLength;
+        }
+        break;
+    }
+    }
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cmath>
+#include <limits>
+#include <optional>
+#include <vector>
+#include <glm/glm.hpp>
+
+// Analytic collider for static geometry. Shapes are stored in world space;
+// a box keeps its orientation so a scaled and rotated cube stays exact.
+class ColliderShape
+{
+public:
+    enum class Type
+    {
+        Box,
+        Plane,
+        Sphere,
+        Capsule
+    };
+
+    static ColliderShape makeBox(const glm::mat4& model, const glm::vec3& localCentre, const glm::vec3& localHalfExtents);
+    static ColliderShape makePlane(const glm::vec3& normal, const glm::vec3& point);
+    static ColliderShape makeSphere(const glm::vec3& centre, float radius);
+    static ColliderShape makeCapsule(const glm::vec3& a, const glm::vec3& b, float radius);
+
+    // recognises meshes that are a box or a sphere in local space
+    static std::optional<ColliderShape> detect(const std::vector<glm::vec3>& localPositions, const glm::mat4& model);
+
+    Type getType() const { return m_type; }
+    bool operator==(const ColliderShape& other) const = default;
+
+    bool findContact(const glm::vec3& p, glm::vec3& normal, float& depth) const;
+
+    // depth[i] > 0 marks a particle inside the shape
+    void findContacts(
+        const std::vector<glm::vec3>& x,
+        std::vector<float>& depth,
+        std::vector<glm::vec3>& normal
+    ) const;
+
+private:
+    ColliderShape() = default;
+
+private:
+    Type m_type = Type::Box;
+
+    // box: orientation, centre and half extents
+    // plane: normal in axes[1], offset in radius, solid below the plane
+    // sphere: centre and radius
+    // capsule: segment from centre to centre + segment, and radius
+    glm::mat3 m_axes = glm::mat3(1.0f);
+    glm::vec3 m_centre = glm::vec3(0.0f);
+    glm::vec3 m_halfExtents = glm::vec3(0.0f);
+    glm::vec3 m_segment = glm::vec3(0.0f);
+    float m_radius = 0.0f;
+};
@@ -0,0 +1,515 @@
+#include "ConvexHull.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <unordered_map>
+
+namespace
+{
+    struct HullFace
+    {
+        std::array<unsigned int, 3> v;
+        glm::vec3 normal;
+        float offset;
+        std::vector<unsigned int> outside;
+        bool removed = false;
+    };
+
+    HullFace makeFace(const std::vector<glm::vec3>& points, unsigned int a, unsigned int b, unsigned int c)
+    {
+        HullFace face;
+        face.v = { a, b, c };
+        glm::vec3 n = glm::cross(points[b] - points[a], points[c] - points[a]);
+        float length = glm::length(n);
+        face.normal = length > 0.0f ? n / length : glm::vec3(0.0f);
+        face.offset = glm::dot(face.normal, points[a]);
+        return face;
+    }
+
+    float distanceTo(const HullFace& face, const glm::vec3& p)
+    {
+        return glm::dot(face.normal, p) - face.offset;
+    }
+
+    uint64_t edgeKey(unsigned int a, unsigned int b)
+    {
+        return (static_cast<uint64_t>(a) << 32) | b;
+    }
+
+    // closest points to the origin; mask marks the vertices that support them
+    glm::vec3 closestOnSegment(const glm::vec3& a, const glm::vec3& b, int& mask)
+    {
+        glm::vec3 ab = b - a;
+        float lengthSq = glm::dot(ab, ab);
+        float t = lengthSq > 0.0f ? glm::dot(-a, ab) / lengthSq : 0.0f;
+        if (t <= 0.0f) { mask = 1; return a; }
+        if (t >= 1.0f) { mask = 2; return b; }
+        mask = 3;
+        return a + t * ab;
+    }
+
+    // Ericson, Real-Time Collision Detection, 5.1.5
+    glm::vec3 closestOnTriangle(const glm::vec3& a, const glm::vec3& b, const glm::vec3& c, int& mask)
+    {
+        glm::vec3 ab = b - a;
+        glm::vec3 ac = c - a;
+
+        float d1 = glm::dot(ab, -a);
+        float d2 = glm::dot(ac, -a);
+        if (d1 <= 0.0f && d2 <= 0.0f) { mask = 1; return a; }
+
+        float d3 = glm::dot(ab, -b);
+        float d4 = glm::dot(ac, -b);
+        if (d3 >= 0.0f && d4 <= d3) { mask = 2; return b; }
+
+        float vc = d1 * d4 - d3 * d2;
+        if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f) { mask = 3; return a + d1 / (d1 - d3) * ab; }
+
+        float d5 = glm::dot(ab, -c);
+        float d6 = glm::dot(ac, -c);
+        if (d6 >= 0.0f && d5 <= d6) { mask = 4; return c; }
+
+        float vb = d5 * d2 - d1 * d6;
+        if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f) { mask = 5; return a + d2 / (d2 - d6) * ac; }
+
+        float va = d3 * d6 - d5 * d4;
+        if (va <= 0.0f && d4 - d3 >= 0.0f && d5 - d6 >= 0.0f)
+        {
+            mask = 6;
+            return b + (d4 - d3) / ((d4 - d3) + (d5 - d6)) * (c - b);
+        }
+
+        float sum = va + vb + vc;
+        if (sum > std::numeric_limits<float>::min())
+        {
+            mask = 7;
+            return a + ab * (vb / sum) + ac * (vc / sum);
+        }
+
+        // collinear vertices: the best of the edges
+        int maskAB, maskAC, maskBC;
+        glm::vec3 pAB = closestOnSegment(a, b, maskAB);
+        glm::vec3 pAC = closestOnSegment(a, c, maskAC);
+        glm::vec3 pBC = closestOnSegment(b, c, maskBC);
+        float dAB = glm::dot(pAB, pAB);
+        float dAC = glm::dot(pAC, pAC);
+        float dBC = glm::dot(pBC, pBC);
+        if (dAB <= dAC && dAB <= dBC) { mask = maskAB; return pAB; }
+        if (dAC <= dBC) { mask = (maskAC & 1) | ((maskAC & 2) << 1); return pAC; }
+        mask = maskBC << 1;
+        return pBC;
+    }
+
+    // closest point to the origin on the simplex, which is reduced to the
+    // vertices that support it; a tetrahedron is kept if it holds the origin
+    glm::vec3 reduceSimplex(std::array<glm::vec3, 4>& w, std::array<unsigned int, 4>& ids, int& size)
+    {
+        int mask = 0;
+        glm::vec3 closest(0.0f);
+        std::array<int, 3> vertices = { 0, 1, 2 };
+
+        if (size == 1)
+        {
+            return w[0];
+        }
+        else if (size == 2)
+        {
+            closest = closestOnSegment(w[0], w[1], mask);
+        }
+        else if (size == 3)
+        {
+            closest = closestOnTriangle(w[0], w[1], w[2], mask);
+        }
+        else
+        {
+            // faces with the vertex opposite them
+            static constexpr int faces[4][4] = {
+                { 0, 1, 2, 3 },
+                { 0, 2, 3, 1 },
+                { 0, 3, 1, 2 },
+                { 1, 3, 2, 0 }
+            };
+
+            float best = std::numeric_limits<float>::max();
+            for (const auto& face : faces)
+            {
+                const glm::vec3& a = w[face[0]];
+                glm::vec3 n = glm::cross(w[face[1]] - a, w[face[2]] - a);
+                float sideOrigin = glm::dot(n, -a);
+                float sideOpposite = glm::dot(n, w[face[3]] - a);
+                if (sideOrigin * sideOpposite > 0.0f) continue;
+                if (sideOrigin == 0.0f && sideOpposite != 0.0f) continue;
+
+                int faceMask;
+                glm::vec3 p = closestOnTriangle(a, w[face[1]], w[face[2]], faceMask);
+                float distanceSq = glm::dot(p, p);
+                if (distanceSq < best)
+                {
+                    best = distanceSq;
+                    closest = p;
+                    mask = faceMask;
+                    vertices = { face[0], face[1], face[2] };
+                }
+            }
+
+            if (best == std::numeric_limits<float>::max())
+            {
+                return glm::vec3(0.0f);
+            }
+        }
+
+        std::array<glm::vec3, 4> keptW;
+        std::array<unsigned int, 4> keptIds;
+        int kept = 0;
+        for (int i = 0; i < 3; ++i)
+        {
+            if (mask & (1 << i))
+            {
+                keptW[kept] = w[vertices[i]];
+                keptIds[kept] = ids[vertices[i]];
+                ++kept;
+            }
+        }
+        w = keptW;
+        ids = keptIds;
+        size = kept;
+        return closest;
+    }
+}
+
+ConvexHull::ConvexHull(const std::vector<glm::vec3>& points)
+{
+    if (points.size() < 4) return;
+
+    m_min = glm::vec3(std::numeric_limits<float>::max());
+    m_max = glm::vec3(-std::numeric_limits<float>::max());
+    for (const auto& p : points)
+    {
+        m_min = glm::min(m_min, p);
+        m_max = glm::max(m_max, p);
+    }
+    glm::vec3 extent = m_max - m_min;
+    m_tolerance = 1e-5f * std::max({ extent.x, extent.y, extent.z });
+
+    // initial tetrahedron from the extreme points
+    std::array<unsigned int, 6> extremes = { 0, 0, 0, 0, 0, 0 };
+    for (unsigned int i = 0; i < points.size(); ++i)
+    {
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            if (points[i][axis] < points[extremes[2 * axis]][axis]) extremes[2 * axis] = i;
+            if (points[i][axis] > points[extremes[2 * axis + 1]][axis]) extremes[2 * axis + 1] = i;
+        }
+    }
+
+    unsigned int a = 0, b = 0;
+    float best = -1.0f;
+    for (unsigned int i : extremes)
+    {
+        for (unsigned int j : extremes)
+        {
+            glm::vec3 d = points[j] - points[i];
+            if (glm::dot(d, d) > best)
+            {
+                best = glm::dot(d, d);
+                a = i;
+                b = j;
+            }
+        }
+    }
+
+    unsigned int c = a;
+    best = 0.0f;
+    glm::vec3 ab = points[b] - points[a];
+    for (unsigned int i = 0; i < points.size(); ++i)
+    {
+        float area = glm::length(glm::cross(ab, points[i] - points[a]));
+        if (area > best)
+        {
+            best = area;
+            c = i;
+        }
+    }
+
+    unsigned int d = a;
+    best = 0.0f;
+    glm::vec3 n = glm::normalize(glm::cross(ab, points[c] - points[a]));
+    for (unsigned int i = 0; i < points.size(); ++i)
+    {
+        float height = std::abs(glm::dot(n, points[i] - points[a]));
+        if (height > best)
+        {
+            best = height;
+            d = i;
+        }
+    }
+
+    // flat or degenerate point sets have no volume to collide with
+    if (c == a || d == a || best <= m_tolerance) return;
+
+    std::vector<HullFace> faces;
+    glm::vec3 centroid = 0.25f * (points[a] + points[b] + points[c] + points[d]);
+    for (const auto& tri : { std::array<unsigned int, 3>{ a, b, c },
+                             std::array<unsigned int, 3>{ a, c, d },
+                             std::array<unsigned int, 3>{ a, d, b },
+                             std::array<unsigned int, 3>{ b, d, c } })
+    {
+        HullFace face = makeFace(points, tri[0], tri[1], tri[2]);
+        if (distanceTo(face, centroid) > 0.0f)
+        {
+            face = makeFace(points, tri[0], tri[2], tri[1]);
+        }
+        faces.push_back(face);
+    }
+
+    auto assignOutside = [&](unsigned int point, size_t firstFace) {
+        for (size_t f = firstFace; f < faces.size(); ++f)
+        {
+            if (!faces[f].removed && distanceTo(faces[f], points[point]) > m_tolerance)
+            {
+                faces[f].outside.push_back(point);
+                return;
+            }
+        }
+    };
+
+    for (unsigned int i = 0; i < points.size(); ++i)
+    {
+        if (i == a || i == b || i == c || i == d) continue;
+        assignOutside(i, 0);
+    }
+
+    std::unordered_map<uint64_t, size_t> edgeFaces;
+    for (size_t f = 0; f < faces.size(); ++f)
+    {
+        for (int e = 0; e < 3; ++e)
+        {
+            edgeFaces[edgeKey(faces[f].v[e], faces[f].v[(e + 1) % 3])] = f;
+        }
+    }
+
+    std::vector<size_t> visible;
+    std::vector<size_t> stack;
+    std::vector<std::array<unsigned int, 2>> horizon;
+    std::vector<unsigned int> orphans;
+    std::vector<char> isVisible;
+    for (size_t f = 0; f < faces.size(); ++f)
+    {
+        if (faces[f].removed || faces[f].outside.empty()) continue;
+
+        // the farthest point outside this face becomes a hull vertex
+        unsigned int eye = faces[f].outside[0];
+        float eyeDistance = distanceTo(faces[f], points[eye]);
+        for (unsigned int i : faces[f].outside)
+        {
+            float distance = distanceTo(faces[f], points[i]);
+            if (distance > eyeDistance)
+            {
+                eyeDistance = distance;
+                eye = i;
+            }
+        }
+
+        // faces the eye can see, grown from this one across shared edges
+        isVisible.assign(faces.size(), 0);
+        visible.clear();
+        stack.assign(1, f);
+        isVisible[f] = 1;
+        while (!stack.empty())
+        {
+            size_t current = stack.back();
+            stack.pop_back();
+            visible.push_back(current);
+            for (int e = 0; e < 3; ++e)
+            {
+                auto it = edgeFaces.find(edgeKey(faces[current].v[(e + 1) % 3], faces[current].v[e]));
+                if (it == edgeFaces.end()) continue;
+
+                size_t neighbour = it->second;
+                if (isVisible[neighbour] || distanceTo(faces[neighbour], points[eye]) <= m_tolerance) continue;
+
+                isVisible[neighbour] = 1;
+                stack.push_back(neighbour);
+            }
+        }
+
+        // edges between visible and hidden faces bound the hole the new
+        // faces close
+        horizon.clear();
+        orphans.clear();
+        for (size_t v : visible)
+        {
+            for (int e = 0; e < 3; ++e)
+            {
+                unsigned int from = faces[v].v[e];
+                unsigned int to = faces[v].v[(e + 1) % 3];
+                auto it = edgeFaces.find(edgeKey(to, from));
+                if (it == edgeFaces.end() || !isVisible[it->second])
+                {
+                    horizon.push_back({ from, to });
+                }
+            }
+        }
+
+        for (size_t v : visible)
+        {
+            for (int e = 0; e < 3; ++e)
+            {
+                edgeFaces.erase(edgeKey(faces[v].v[e], faces[v].v[(e + 1) % 3]));
+            }
+            for (unsigned int i : faces[v].outside)
+            {
+                if (i != eye) orphans.push_back(i);
+            }
+            faces[v].outside.clear();
+            faces[v].outside.shrink_to_fit();
+            faces[v].removed = true;
+        }
+
+        size_t firstNew = faces.size();
+        for (const auto& edge : horizon)
+        {
+            faces.push_back(makeFace(points, edge[0], edge[1], eye));
+            const HullFace& face = faces.back();
+            for (int e = 0; e < 3; ++e)
+            {
+                edgeFaces[edgeKey(face.v[e], face.v[(e + 1) % 3])] = faces.size() - 1;
+            }
+        }
+
+        for (unsigned int i : orphans)
+        {
+            assignOutside(i, firstNew);
+        }
+    }
+
+    // keep the live faces and the vertices they use
+    std::unordered_map<unsigned int, unsigned int> remap;
+    for (const auto& face : faces)
+    {
+        if (face.removed) continue;
+
+        std::array<unsigned int, 3> v;
+        for (int i = 0; i < 3; ++i)
+        {
+            auto [it, inserted] = remap.try_emplace(face.v[i], static_cast<unsigned int>(m_vertices.size()));
+            if (inserted) m_vertices.push_back(points[face.v[i]]);
+            v[i] = it->second;
+        }
+        m_triangles.push_back({ v[0], v[1], v[2] });
+        m_normals.push_back(face.normal);
+        m_offsets.push_back(face.offset);
+    }
+}
+
+bool ConvexHull::isSurfaceOf(const std::vector<glm::vec3>& points) const
+{
+    if (empty()) return false;
+
+    // a point of a concave region lies clearly inside every face plane
+    const float tolerance = 100.0f * m_tolerance;
+    for (const auto& p : points)
+    {
+        float maxDistance = -std::numeric_limits<float>::max();
+        for (size_t f = 0; f < m_normals.size(); ++f)
+        {
+            maxDistance = std::max(maxDistance, glm::dot(m_normals[f], p) - m_offsets[f]);
+        }
+        if (maxDistance < -tolerance) return false;
+    }
+    return true;
+}
+
+unsigned int ConvexHull::findSupport(const glm::vec3& direction) const
+{
+    unsigned int support = 0;
+    float best = glm::dot(m_vertices[0], direction);
+    for (unsigned int i = 1; i < m_vertices.size(); ++i)
+    {
+        float projection = glm::dot(m_vertices[i], direction);
+        if (projection > best)
+        {
+            best = projection;
+            support = i;
+        }
+    }
+    return support;
+}
+
+bool ConvexHull::findClosestPoint(const glm::vec3& p, Simplex& simplex, glm::vec3& closest) const
+{
+    if (empty()) return false;
+
+    // GJK on the hull translated by -p, whose point closest to the origin is
+    // the answer; the cached simplex is usually already close to it
+    std::array<glm::vec3, 4> w;
+    std::array<unsigned int, 4> ids;
+    int size = 0;
+    for (int i = 0; i < simplex.size; ++i)
+    {
+        if (simplex.vertices[i] >= m_vertices.size()) continue;
+        ids[size] = simplex.vertices[i];
+        w[size] = m_vertices[ids[size]] - p;
+        ++size;
+    }
+    if (size == 0)
+    {
+        ids[0] = findSupport(p - 0.5f * (m_min + m_max));
+        w[0] = m_vertices[ids[0]] - p;
+        size = 1;
+    }
+
+    glm::vec3 v(0.0f);
+    bool outside = true;
+    const int maxIterations = 64;
+    for (int iteration = 0; iteration < maxIterations; ++iteration)
+    {
+        v = reduceSimplex(w, ids, size);
+        float distanceSq = glm::dot(v, v);
+        if (size == 4 || distanceSq <= m_tolerance * m_tolerance)
+        {
+            outside = false;
+            break;
+        }
+
+        unsigned int support = findSupport(-v);
+        glm::vec3 supportW = m_vertices[support] - p;
+        if (distanceSq - glm::dot(v, supportW) <= 1e-5f * distanceSq ||
+            std::find(ids.begin(), ids.begin() + size, support) != ids.begin() + size)
+        {
+            break;
+        }
+
+        ids[size] = support;
+        w[size] = supportW;
+        ++size;
+    }
+
+    simplex.vertices = ids;
+    simplex.size = size;
+    closest = v + p;
+    return outside;
+}
+
+bool ConvexHull::findContact(const glm::vec3& p, glm::vec3& normal, float& depth) const
+{
+    if (empty()) return false;
+
+    // inside a hull the nearest face plane is the nearest surface point
+    float maxDistance = -std::numeric_limits<float>::max();
+    size_t nearest = 0;
+    for (size_t f = 0; f < m_normals.size(); ++f)
+    {
+        float distance = glm::dot(m_normals[f], p) - m_offsets[f];
+        if (distance >= 0.0f) return false;
+        if (distance > maxDistance)
+        {
+            maxDistance = distance;
+            nearest = f;
+        }
+    }
+
+    normal = m_normals[nearest];
+    depth = -maxDistance;
+    return true;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "Mesh.hpp"
+
+// Convex hull of a point set, built with Quickhull (Barber et al. 1996).
+// Distances from outside come from GJK against the hull's vertices, warm
+// started from the simplex the previous query ended with; points inside are
+// pushed out through the nearest face plane.
+class ConvexHull
+{
+public:
+    // hull vertices GJK ended with; kept per particle between queries
+    struct Simplex
+    {
+        std::array<unsigned int, 4> vertices;
+        int size = 0;
+    };
+
+    ConvexHull() = default;
+    explicit ConvexHull(const std::vector<glm::vec3>& points);
+
+    bool empty() const { return m_triangles.empty(); }
+    const std::vector<glm::vec3>& getVertices() const { return m_vertices; }
+    const std::vector<Triangle>& getTriangles() const { return m_triangles; }
+    const glm::vec3& getMin() const { return m_min; }
+    const glm::vec3& getMax() const { return m_max; }
+
+    // every point lies on the hull's surface, so the points' mesh is convex
+    bool isSurfaceOf(const std::vector<glm::vec3>& points) const;
+
+    // closest point on the hull to p; false if p is inside
+    bool findClosestPoint(const glm::vec3& p, Simplex& simplex, glm::vec3& closest) const;
+
+    // point inside the hull, pushed out through the nearest face
+    bool findContact(const glm::vec3& p, glm::vec3& normal, float& depth) const;
+
+private:
+    unsigned int findSupport(const glm::vec3& direction) const;
+
+private:
+    std::vector<glm::vec3> m_vertices;
+    std::vector<Triangle> m_triangles;
+
+    // face planes, n . x = d
+    std::vector<glm::vec3> m_normals;
+    std::vector<float> m_offsets;
+
+    glm::vec3 m_min = glm::vec3(0.0f);
+    glm::vec3 m_max = glm::vec3(0.0f);
+    float m_tolerance = 0.0f;
+};
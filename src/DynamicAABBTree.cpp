@@ -0,0 +1,324 @@
+#include "DynamicAABBTree.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+
+DynamicAABBTree::DynamicAABBTree(float margin)
+    : m_root(NullNode),
+      m_freeList(NullNode),
+      m_margin(margin)
+{
+}
+
+void DynamicAABBTree::clear()
+{
+    m_nodes.clear();
+    m_root = NullNode;
+    m_freeList = NullNode;
+}
+
+int DynamicAABBTree::allocateNode()
+{
+    int node;
+    if (m_freeList != NullNode)
+    {
+        node = m_freeList;
+        m_freeList = m_nodes[node].parent;
+    }
+    else
+    {
+        node = static_cast<int>(m_nodes.size());
+        m_nodes.push_back({});
+    }
+
+    m_nodes[node] = { glm::vec3(0.0f), glm::vec3(0.0f), NullNode, NullNode, NullNode, 0, -1 };
+    return node;
+}
+
+void DynamicAABBTree::freeNode(int node)
+{
+    m_nodes[node].parent = m_freeList;
+    m_nodes[node].height = -1;
+    m_freeList = node;
+}
+
+float DynamicAABBTree::calculateSurfaceArea(const glm::vec3& min, const glm::vec3& max)
+{
+    glm::vec3 e = max - min;
+    return 2.0f * (e.x * e.y + e.y * e.z + e.z * e.x);
+}
+
+bool DynamicAABBTree::overlap(const Node& a, const glm::vec3& min, const glm::vec3& max)
+{
+    return glm::all(glm::lessThanEqual(a.min, max)) && glm::all(glm::lessThanEqual(min, a.max));
+}
+
+bool DynamicAABBTree::intersect(const Node& a, const glm::vec3& origin, const glm::vec3& invDirection, float maxT)
+{
+    glm::vec3 t0 = (a.min - origin) * invDirection;
+    glm::vec3 t1 = (a.max - origin) * invDirection;
+    glm::vec3 tNear = glm::min(t0, t1);
+    glm::vec3 tFar = glm::max(t0, t1);
+    float enter = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.0f));
+    float exit = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, maxT));
+    return enter <= exit;
+}
+
+int DynamicAABBTree::createProxy(const glm::vec3& min, const glm::vec3& max, int userData)
+{
+    int leaf = allocateNode();
+    m_nodes[leaf].min = min - m_margin;
+    m_nodes[leaf].max = max + m_margin;
+    m_nodes[leaf].userData = userData;
+    insertLeaf(leaf);
+    return leaf;
+}
+
+bool DynamicAABBTree::moveProxy(int proxy, const glm::vec3& min, const glm::vec3& max)
+{
+    Node& leaf = m_nodes[proxy];
+    if (glm::all(glm::lessThanEqual(leaf.min, min)) && glm::all(glm::lessThanEqual(max, leaf.max)))
+    {
+        return false;
+    }
+
+    removeLeaf(proxy);
+    m_nodes[proxy].min = min - m_margin;
+    m_nodes[proxy].max = max + m_margin;
+    insertLeaf(proxy);
+    return true;
+}
+
+void DynamicAABBTree::insertLeaf(int leaf)
+{
+    if (m_root == NullNode)
+    {
+        m_root = leaf;
+        m_nodes[leaf].parent = NullNode;
+        return;
+    }
+
+    // descend towards the sibling with the cheapest enlarged area
+    const glm::vec3 leafMin = m_nodes[leaf].min;
+    const glm::vec3 leafMax = m_nodes[leaf].max;
+    int index = m_root;
+    while (!m_nodes[index].isLeaf())
+    {
+        const Node& node = m_nodes[index];
+        float area = calculateSurfaceArea(node.min, node.max);
+        float combinedArea = calculateSurfaceArea(glm::min(node.min, leafMin), glm::max(node.max, leafMax));
+
+        // cost of making a new parent here, and the minimum cost of pushing
+        // the leaf further down
+        float cost = 2.0f * combinedArea;
+        float inheritanceCost = 2.0f * (combinedArea - area);
+
+        auto childCost = [&](int child) {
+            const Node& c = m_nodes[child];
+            float enlarged = calculateSurfaceArea(glm::min(c.min, leafMin), glm::max(c.max, leafMax));
+            return c.isLeaf() ? enlarged + inheritanceCost
+                              : enlarged - calculateSurfaceArea(c.min, c.max) + inheritanceCost;
+        };
+        float cost1 = childCost(node.child1);
+        float cost2 = childCost(node.child2);
+
+        if (cost < cost1 && cost < cost2) break;
+        index = cost1 < cost2 ? node.child1 : node.child2;
+    }
+
+    int sibling = index;
+    int oldParent = m_nodes[sibling].parent;
+    int newParent = allocateNode();
+    m_nodes[newParent].parent = oldParent;
+    m_nodes[newParent].min = glm::min(m_nodes[sibling].min, leafMin);
+    m_nodes[newParent].max = glm::max(m_nodes[sibling].max, leafMax);
+    m_nodes[newParent].height = m_nodes[sibling].height + 1;
+    m_nodes[newParent].child1 = sibling;
+    m_nodes[newParent].child2 = leaf;
+    m_nodes[sibling].parent = newParent;
+    m_nodes[leaf].parent = newParent;
+
+    if (oldParent == NullNode)
+    {
+        m_root = newParent;
+    }
+    else if (m_nodes[oldParent].child1 == sibling)
+    {
+        m_nodes[oldParent].child1 = newParent;
+    }
+    else
+    {
+        m_nodes[oldParent].child2 = newParent;
+    }
+
+    fixUpwards(m_nodes[leaf].parent);
+}
+
+void DynamicAABBTree::removeLeaf(int leaf)
+{
+    if (leaf == m_root)
+    {
+        m_root = NullNode;
+        return;
+    }
+
+    int parent = m_nodes[leaf].parent;
+    int grandParent = m_nodes[parent].parent;
+    int sibling = m_nodes[parent].child1 == leaf ? m_nodes[parent].child2 : m_nodes[parent].child1;
+
+    if (grandParent == NullNode)
+    {
+        m_root = sibling;
+        m_nodes[sibling].parent = NullNode;
+        freeNode(parent);
+        return;
+    }
+
+    if (m_nodes[grandParent].child1 == parent)
+    {
+        m_nodes[grandParent].child1 = sibling;
+    }
+    else
+    {
+        m_nodes[grandParent].child2 = sibling;
+    }
+    m_nodes[sibling].parent = grandParent;
+    freeNode(parent);
+
+    fixUpwards(grandParent);
+}
+
+void DynamicAABBTree::fixUpwards(int node)
+{
+    while (node != NullNode)
+    {
+        node = balance(node);
+
+        Node& n = m_nodes[node];
+        const Node& c1 = m_nodes[n.child1];
+        const Node& c2 = m_nodes[n.child2];
+        n.height = 1 + std::max(c1.height, c2.height);
+        n.min = glm::min(c1.min, c2.min);
+        n.max = glm::max(c1.max, c2.max);
+
+        node = n.parent;
+    }
+}
+
+int DynamicAABBTree::balance(int a)
+{
+    Node& A = m_nodes[a];
+    if (A.isLeaf() || A.height < 2) return a;
+
+    int b = A.child1;
+    int c = A.child2;
+    int heightDiff = m_nodes[c].height - m_nodes[b].height;
+    if (std::abs(heightDiff) <= 1) return a;
+
+    // rotate the taller child up; its shorter grandchild moves down to a
+    int up = heightDiff > 0 ? c : b;
+    int other = heightDiff > 0 ? b : c;
+    Node& U = m_nodes[up];
+    int f = U.child1;
+    int g = U.child2;
+
+    U.child1 = a;
+    U.parent = A.parent;
+    A.parent = up;
+
+    if (U.parent == NullNode)
+    {
+        m_root = up;
+    }
+    else if (m_nodes[U.parent].child1 == a)
+    {
+        m_nodes[U.parent].child1 = up;
+    }
+    else
+    {
+        m_nodes[U.parent].child2 = up;
+    }
+
+    int keep = m_nodes[f].height > m_nodes[g].height ? f : g;
+    int move = keep == f ? g : f;
+    U.child2 = keep;
+    if (heightDiff > 0)
+    {
+        A.child2 = move;
+    }
+    else
+    {
+        A.child1 = move;
+    }
+    m_nodes[move].parent = a;
+
+    const Node& o = m_nodes[other];
+    const Node& m = m_nodes[move];
+    const Node& k = m_nodes[keep];
+    A.min = glm::min(o.min, m.min);
+    A.max = glm::max(o.max, m.max);
+    A.height = 1 + std::max(o.height, m.height);
+    U.min = glm::min(A.min, k.min);
+    U.max = glm::max(A.max, k.max);
+    U.height = 1 + std::max(A.height, k.height);
+
+    return up;
+}
+
+void DynamicAABBTree::query(const glm::vec3& min, const glm::vec3& max, std::vector<int>& userData) const
+{
+    userData.clear();
+    if (m_root == NullNode) return;
+
+    std::vector<int> stack = { m_root };
+    while (!stack.empty())
+    {
+        int index = stack.back();
+        stack.pop_back();
+
+        const Node& node = m_nodes[index];
+        if (!overlap(node, min, max)) continue;
+
+        if (node.isLeaf())
+        {
+            userData.push_back(node.userData);
+        }
+        else
+        {
+            stack.push_back(node.child1);
+            stack.push_back(node.child2);
+        }
+    }
+}
+
+void DynamicAABBTree::raycast(
+    const glm::vec3& origin,
+    const glm::vec3& direction,
+    float maxT,
+    std::vector<int>& userData
+) const
+{
+    userData.clear();
+    if (m_root == NullNode) return;
+
+    glm::vec3 invDirection = 1.0f / direction;
+    std::vector<int> stack = { m_root };
+    while (!stack.empty())
+    {
+        int index = stack.back();
+        stack.pop_back();
+
+        const Node& node = m_nodes[index];
+        if (!intersect(node, origin, invDirection, maxT)) continue;
+
+        if (node.isLeaf())
+        {
+            userData.push_back(node.userData);
+        }
+        else
+        {
+            stack.push_back(node.child1);
+            stack.push_back(node.child2);
+        }
+    }
+}
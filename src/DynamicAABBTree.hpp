@@ -0,0 +1,62 @@
+#pragma once
+
+#include <vector>
+#include <glm/glm.hpp>
+
+// Incrementally updated bounding volume tree over moving objects. Leaves store
+// boxes enlarged by a margin, so small motions don't touch the tree; leaves are
+// inserted by the surface area heuristic and the tree is kept balanced with AVL
+// rotations.
+class DynamicAABBTree
+{
+public:
+    explicit DynamicAABBTree(float margin = 0.1f);
+
+    int createProxy(const glm::vec3& min, const glm::vec3& max, int userData);
+
+    // returns true if the leaf had to be reinserted
+    bool moveProxy(int proxy, const glm::vec3& min, const glm::vec3& max);
+
+    int getUserData(int proxy) const { return m_nodes[proxy].userData; }
+    void clear();
+
+    // user data of every leaf whose fat box overlaps [min, max]
+    void query(const glm::vec3& min, const glm::vec3& max, std::vector<int>& userData) const;
+
+    // user data of every leaf whose fat box the segment origin + t * direction,
+    // 0 <= t <= maxT, passes through
+    void raycast(const glm::vec3& origin, const glm::vec3& direction, float maxT, std::vector<int>& userData) const;
+
+private:
+    static constexpr int NullNode = -1;
+
+    struct Node
+    {
+        glm::vec3 min;
+        glm::vec3 max;
+        int parent;     // next free node while on the free list
+        int child1;
+        int child2;
+        int height;     // 0 for leaves, -1 for free nodes
+        int userData;
+
+        bool isLeaf() const { return child1 == NullNode; }
+    };
+
+    int allocateNode();
+    void freeNode(int node);
+    void insertLeaf(int leaf);
+    void removeLeaf(int leaf);
+    int balance(int node);
+    void fixUpwards(int node);
+
+    static bool overlap(const Node& a, const glm::vec3& min, const glm::vec3& max);
+    static bool intersect(const Node& a, const glm::vec3& origin, const glm::vec3& invDirection, float maxT);
+    static float calculateSurfaceArea(const glm::vec3& min, const glm::vec3& max);
+
+private:
+    std::vector<Node> m_nodes;
+    int m_root;
+    int m_freeList;
+    float m_margin;
+};
@@ -0,0 +1,293 @@
+#include "FluidSystem.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+FluidSystem::FluidSystem(
+    std::string name,
+    Transform transform,
+    Shader shader,
+    float particleRadius
+)
+    :   m_name(std::move(name)),
+        m_transform(transform),
+        m_shader(shader),
+        m_particleRadius(particleRadius),
+        m_kernelRadius(4.0f * particleRadius),
+        m_restDensity(1.0f),
+        m_relaxation(0.0f),
+        m_correctionStrength(0.0f),
+        m_solverIterations(2),
+        m_viscosity(0.01f),
+        m_VAO(0),
+        m_VBO(0),
+        m_bufferCapacity(0)
+{
+    const float pi = 3.14159265358979f;
+    float h = m_kernelRadius;
+    m_poly6Scale = 315.0f / (64.0f * pi * std::pow(h, 9.0f));
+    m_spikyScale = -45.0f / (pi * std::pow(h, 6.0f));
+
+    // tensile correction is relative to the kernel at 0.2 h
+    m_correctionScale = 1.0f / calculatePoly6(0.04f * h * h);
+
+    // rest density and constraint stiffness of a particle inside a block at
+    // rest spacing, with unit masses
+    float spacing = 2.0f * particleRadius;
+    float density = 0.0f;
+    float sumGradient2 = 0.0f;
+    for (int i = -2; i <= 2; ++i)
+    {
+        for (int j = -2; j <= 2; ++j)
+        {
+            for (int k = -2; k <= 2; ++k)
+            {
+                glm::vec3 d = spacing * glm::vec3(i, j, k);
+                float r2 = glm::dot(d, d);
+                density += calculatePoly6(r2);
+
+                glm::vec3 gradient = calculateSpikyGradient(d, std::sqrt(r2));
+                sumGradient2 += glm::dot(gradient, gradient);
+            }
+        }
+    }
+    m_restDensity = density;
+
+    // the relaxation and the tensile correction are in units of lambda, so
+    // both are set relative to the constraint stiffness at rest
+    float stiffness = sumGradient2 / (density * density);
+    m_relaxation = 0.1f * stiffness;
+    m_correctionStrength = 0.001f / stiffness;
+
+    m_hash.setSpacing(m_kernelRadius);
+
+    glGenVertexArrays(1, &m_VAO);
+    glGenBuffers(1, &m_VBO);
+
+    glBindVertexArray(m_VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)0);
+    glBindVertexArray(0);
+}
+
+FluidSystem::~FluidSystem()
+{
+    glDeleteVertexArrays(1, &m_VAO);
+    glDeleteBuffers(1, &m_VBO);
+}
+
+void FluidSystem::addBlock(const glm::vec3& min, const glm::vec3& max)
+{
+    float spacing = 2.0f * m_particleRadius;
+    glm::ivec3 count = glm::max(glm::ivec3((max - min) / spacing), glm::ivec3(0));
+
+    // a perfect lattice keeps particles stacked in columns that collisions can
+    // flatten onto one point, where the kernel gradient vanishes
+    std::minstd_rand random(static_cast<unsigned int>(m_initialPositions.size()) + 1);
+    std::uniform_real_distribution<float> jitter(-0.01f * spacing, 0.01f * spacing);
+    for (int i = 0; i < count.x; ++i)
+    {
+        for (int j = 0; j < count.y; ++j)
+        {
+            for (int k = 0; k < count.z; ++k)
+            {
+                glm::vec3 p = min + m_particleRadius + spacing * glm::vec3(i, j, k);
+                p += glm::vec3(jitter(random), jitter(random), jitter(random));
+                p = glm::clamp(p, min + m_particleRadius, max - m_particleRadius);
+                m_initialPositions.push_back(p);
+            }
+        }
+    }
+
+    reset();
+}
+
+void FluidSystem::reset()
+{
+    size_t n = m_initialPositions.size();
+    m_positions = m_initialPositions;
+    m_x = m_initialPositions;
+    m_velocities.assign(n, glm::vec3(0.0f));
+    m_lambdas.assign(n, 0.0f);
+    m_deltas.assign(n, glm::vec3(0.0f));
+}
+
+float FluidSystem::calculatePoly6(float r2) const
+{
+    float h2 = m_kernelRadius * m_kernelRadius;
+    if (r2 >= h2) return 0.0f;
+
+    float q = h2 - r2;
+    return m_poly6Scale * q * q * q;
+}
+
+glm::vec3 FluidSystem::calculateSpikyGradient(const glm::vec3& d, float r) const
+{
+    if (r >= m_kernelRadius || r < 1e-6f) return glm::vec3(0.0f);
+
+    float q = m_kernelRadius - r;
+    return (m_spikyScale * q * q / r) * d;
+}
+
+void FluidSystem::predict(float deltaTime_s, const glm::vec3& gravitationalAcceleration)
+{
+    const long long n = static_cast<long long>(m_positions.size());
+
+    #pragma omp parallel for schedule(static)
+    for (long long i = 0; i < n; ++i)
+    {
+        m_velocities[i] += deltaTime_s * gravitationalAcceleration;
+        m_x[i] = m_positions[i] + deltaTime_s * m_velocities[i];
+    }
+}
+
+void FluidSystem::findNeighbours()
+{
+    m_hash.build(m_x);
+    m_hash.findAllNeighbours(m_x, m_kernelRadius, m_neighbourOffsets, m_neighbours);
+}
+
+void FluidSystem::solveDensityConstraints()
+{
+    const long long n = static_cast<long long>(m_x.size());
+    const float invRestDensity = 1.0f / m_restDensity;
+
+    // lambda of every density constraint
+    #pragma omp parallel for schedule(static)
+    for (long long i = 0; i < n; ++i)
+    {
+        float density = calculatePoly6(0.0f);
+        glm::vec3 gradient_i(0.0f);
+        float sumGradient2 = 0.0f;
+        for (unsigned int k = m_neighbourOffsets[i]; k < m_neighbourOffsets[i + 1]; ++k)
+        {
+            glm::vec3 d = m_x[i] - m_x[m_neighbours[k]];
+            float r2 = glm::dot(d, d);
+            density += calculatePoly6(r2);
+
+            glm::vec3 gradient = invRestDensity * calculateSpikyGradient(d, std::sqrt(r2));
+            gradient_i += gradient;
+            sumGradient2 += glm::dot(gradient, gradient);
+        }
+
+        // only compression is resolved, otherwise particles at the free surface
+        // with fewer neighbours would pull together
+        float C = std::max(density * invRestDensity - 1.0f, 0.0f);
+        m_lambdas[i] = -C / (sumGradient2 + glm::dot(gradient_i, gradient_i) + m_relaxation);
+    }
+
+    // corrections from both particles' lambdas, plus the tensile term that
+    // keeps particles at the surface from clumping
+    #pragma omp parallel for schedule(static)
+    for (long long i = 0; i < n; ++i)
+    {
+        glm::vec3 delta(0.0f);
+        for (unsigned int k = m_neighbourOffsets[i]; k < m_neighbourOffsets[i + 1]; ++k)
+        {
+            unsigned int j = m_neighbours[k];
+            glm::vec3 d = m_x[i] - m_x[j];
+            float r2 = glm::dot(d, d);
+
+            float ratio = calculatePoly6(r2) * m_correctionScale;
+            float correction = -m_correctionStrength * ratio * ratio * ratio * ratio;
+            delta += (m_lambdas[i] + m_lambdas[j] + correction) * calculateSpikyGradient(d, std::sqrt(r2));
+        }
+        m_deltas[i] = invRestDensity * delta;
+    }
+
+    #pragma omp parallel for schedule(static)
+    for (long long i = 0; i < n; ++i)
+    {
+        m_x[i] += m_deltas[i];
+    }
+}
+
+void FluidSystem::updateVelocities(float deltaTime_s)
+{
+    const long long n = static_cast<long long>(m_x.size());
+
+    #pragma omp parallel for schedule(static)
+    for (long long i = 0; i < n; ++i)
+    {
+        m_velocities[i] = (m_x[i] - m_positions[i]) / deltaTime_s;
+    }
+
+    // XSPH viscosity blends each velocity towards its neighbours'
+    #pragma omp parallel for schedule(static)
+    for (long long i = 0; i < n; ++i)
+    {
+        glm::vec3 blend(0.0f);
+        for (unsigned int k = m_neighbourOffsets[i]; k < m_neighbourOffsets[i + 1]; ++k)
+        {
+            unsigned int j = m_neighbours[k];
+            glm::vec3 d = m_x[i] - m_x[j];
+            blend += calculatePoly6(glm::dot(d, d)) * (m_velocities[j] - m_velocities[i]);
+        }
+        m_deltas[i] = m_velocities[i] + (m_viscosity / m_restDensity) * blend;
+    }
+
+    #pragma omp parallel for schedule(static)
+    for (long long i = 0; i < n; ++i)
+    {
+        m_velocities[i] = m_deltas[i];
+        m_positions[i] = m_x[i];
+    }
+}
+
+void FluidSystem::uploadPositions()
+{
+    glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
+    if (m_positions.size() > m_bufferCapacity)
+    {
+        m_bufferCapacity = m_positions.size();
+        glBufferData(GL_ARRAY_BUFFER, m_bufferCapacity * sizeof(glm::vec3), m_positions.data(), GL_DYNAMIC_DRAW);
+    }
+    else
+    {
+        glBufferSubData(GL_ARRAY_BUFFER, 0, m_positions.size() * sizeof(glm::vec3), m_positions.data());
+    }
+}
+
+void FluidSystem::render()
+{
+    if (m_positions.empty()) return;
+
+    uploadPositions();
+
+    glm::vec3 lightDirection = glm::vec3(
+        1.0f,
+        0.5f,
+        0.0
+    );
+
+    m_shader.useProgram();
+    m_shader.setVec3("lightDir", lightDirection);
+
+    int projectionLoc = glGetUniformLocation(m_shader.getID(), "projection");
+    glUniformMatrix4fv(projectionLoc, 1, GL_FALSE, glm::value_ptr(m_transform.getProjectionMatrix()));
+
+    int viewLoc = glGetUniformLocation(m_shader.getID(), "view");
+    glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(m_transform.getViewMatrix()));
+
+    int modelLoc = glGetUniformLocation(m_shader.getID(), "model");
+    glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(glm::mat4(1.0f)));
+
+    // sprites are sized so they cover the particle's sphere on screen
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    float pointScale = m_transform.getProjectionMatrix()[1][1] * static_cast<float>(viewport[3]);
+
+    int pointScaleLoc = glGetUniformLocation(m_shader.getID(), "pointScale");
+    glUniform1f(pointScaleLoc, pointScale);
+
+    int pointRadiusLoc = glGetUniformLocation(m_shader.getID(), "pointRadius");
+    glUniform1f(pointRadiusLoc, m_particleRadius);
+
+    glEnable(GL_PROGRAM_POINT_SIZE);
+    glBindVertexArray(m_VAO);
+    glDrawArrays(GL_POINTS, 0, static_cast<GLsizei>(m_positions.size()));
+    glBindVertexArray(0);
+    glDisable(GL_PROGRAM_POINT_SIZE);
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include "Transform.hpp"
+#include "Shader.hpp"
+#include "ParticleHash.hpp"
+
+// Position Based Fluids (Macklin & Mueller 2013). Every particle has one
+// density constraint; the constraints are solved as Jacobi iterations so the
+// density, lambda and position passes each run in parallel over particles.
+// Neighbours come from a ParticleHash rebuilt every substep. Particles live in
+// flat arrays rather than in Objects, and are drawn as point sprites.
+class FluidSystem
+{
+public:
+    FluidSystem(
+        std::string name,
+        Transform transform,
+        Shader shader,
+        float particleRadius
+    );
+    ~FluidSystem();
+
+    FluidSystem(const FluidSystem&) = delete;
+    FluidSystem& operator=(const FluidSystem&) = delete;
+
+    // fills the box with particles at rest spacing
+    void addBlock(const glm::vec3& min, const glm::vec3& max);
+    void reset();
+
+    std::string getName() const { return m_name; }
+    Transform& getTransform() { return m_transform; }
+    size_t getNumParticles() const { return m_positions.size(); }
+    float getParticleRadius() const { return m_particleRadius; }
+    const std::vector<glm::vec3>& getPositions() const { return m_positions; }
+
+    int& getSolverIterations() { return m_solverIterations; }
+    float& getViscosity() { return m_viscosity; }
+
+    // one substep: predict, then per iteration solve the density constraints
+    // and let the caller resolve collisions, then update velocities
+    void predict(float deltaTime_s, const glm::vec3& gravitationalAcceleration);
+    void findNeighbours();
+    void solveDensityConstraints();
+    std::vector<glm::vec3>& getPredictedPositions() { return m_x; }
+    void updateVelocities(float deltaTime_s);
+
+    void render();
+
+private:
+    float calculatePoly6(float r2) const;
+    glm::vec3 calculateSpikyGradient(const glm::vec3& d, float r) const;
+    void uploadPositions();
+
+private:
+    std::string m_name;
+    Transform m_transform;
+    Shader m_shader;
+
+    float m_particleRadius;
+    float m_kernelRadius;
+    float m_restDensity;
+    float m_relaxation;
+    float m_correctionStrength;
+    int m_solverIterations;
+    float m_viscosity;
+
+    // kernel constants
+    float m_poly6Scale;
+    float m_spikyScale;
+    float m_correctionScale;
+
+    std::vector<glm::vec3> m_initialPositions;
+    std::vector<glm::vec3> m_positions;
+    std::vector<glm::vec3> m_velocities;
+    std::vector<glm::vec3> m_x;
+    std::vector<float> m_lambdas;
+    std::vector<glm::vec3> m_deltas;
+
+    ParticleHash m_hash;
+    std::vector<unsigned int> m_neighbourOffsets;
+    std::vector<unsigned int> m_neighbours;
+
+    GLuint m_VAO;
+    GLuint m_VBO;
+    size_t m_bufferCapacity;
+};
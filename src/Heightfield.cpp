@@ -0,0 +1,314 @@
+#include "Heightfield.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <fstream>
+#include <iostream>
+#include <stb_image.h>
+
+Heightfield::Heightfield(
+    std::string name,
+    Transform transform,
+    Shader shader,
+    std::vector<float> heights,
+    int numX,
+    int numZ,
+    const glm::vec3& origin,
+    const glm::vec3& size
+)
+    :   m_name(std::move(name)),
+        m_transform(transform),
+        m_shader(shader),
+        m_heights(std::move(heights)),
+        m_numX(numX),
+        m_numZ(numZ),
+        m_min(origin),
+        m_max(origin + size),
+        m_spacing(size.x / static_cast<float>(numX - 1), size.z / static_cast<float>(numZ - 1)),
+        m_VAO(0),
+        m_VBO(0),
+        m_EBO(0),
+        m_numIndices(0)
+{
+    for (float& height : m_heights)
+    {
+        height = origin.y + height * size.y;
+    }
+
+    setupMesh();
+}
+
+Heightfield::~Heightfield()
+{
+    glDeleteVertexArrays(1, &m_VAO);
+    glDeleteBuffers(1, &m_VBO);
+    glDeleteBuffers(1, &m_EBO);
+}
+
+std::vector<float> Heightfield::loadImage(const std::string& path, int& numX, int& numZ)
+{
+    // the first image row is the -z edge of the terrain
+    stbi_set_flip_vertically_on_load(false);
+
+    int nrComponents;
+    std::vector<float> heights;
+    if (stbi_is_16_bit(path.c_str()))
+    {
+        stbi_us* data = stbi_load_16(path.c_str(), &numX, &numZ, &nrComponents, 1);
+        if (data)
+        {
+            heights.assign(data, data + static_cast<size_t>(numX) * numZ);
+            for (float& height : heights) height /= 65535.0f;
+        }
+        stbi_image_free(data);
+    }
+    else
+    {
+        stbi_uc* data = stbi_load(path.c_str(), &numX, &numZ, &nrComponents, 1);
+        if (data)
+        {
+            heights.assign(data, data + static_cast<size_t>(numX) * numZ);
+            for (float& height : heights) height /= 255.0f;
+        }
+        stbi_image_free(data);
+    }
+
+    if (heights.empty() || numX < 2 || numZ < 2)
+    {
+        std::cerr << "Failed to load heightfield: " << path << std::endl;
+        return {};
+    }
+
+    return heights;
+}
+
+std::vector<float> Heightfield::loadRaw(const std::string& path, int numX, int numZ)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file || numX < 2 || numZ < 2)
+    {
+        std::cerr << "Failed to load heightfield: " << path << std::endl;
+        return {};
+    }
+
+    std::vector<float> heights(static_cast<size_t>(numX) * numZ);
+    file.read(reinterpret_cast<char*>(heights.data()), heights.size() * sizeof(float));
+    if (!file)
+    {
+        std::cerr << "Heightfield " << path << " is smaller than " << numX << "x" << numZ << std::endl;
+        return {};
+    }
+
+    return heights;
+}
+
+bool Heightfield::contains(float x, float z) const
+{
+    return x >= m_min.x && x <= m_max.x && z >= m_min.z && z <= m_max.z;
+}
+
+Heightfield::Cell Heightfield::findCell(float x, float z) const
+{
+    float u = std::clamp((x - m_min.x) / m_spacing.x, 0.0f, static_cast<float>(m_numX - 1));
+    float v = std::clamp((z - m_min.z) / m_spacing.y, 0.0f, static_cast<float>(m_numZ - 1));
+
+    Cell cell;
+    cell.i = std::min(static_cast<int>(u), m_numX - 2);
+    cell.k = std::min(static_cast<int>(v), m_numZ - 2);
+    cell.s = u - static_cast<float>(cell.i);
+    cell.t = v - static_cast<float>(cell.k);
+    return cell;
+}
+
+float Heightfield::getHeight(float x, float z) const
+{
+    Cell cell = findCell(x, z);
+    float h00 = sample(cell.i, cell.k);
+    float h10 = sample(cell.i + 1, cell.k);
+    float h01 = sample(cell.i, cell.k + 1);
+    float h11 = sample(cell.i + 1, cell.k + 1);
+
+    return glm::mix(glm::mix(h00, h10, cell.s), glm::mix(h01, h11, cell.s), cell.t);
+}
+
+glm::vec3 Heightfield::getNormal(float x, float z) const
+{
+    Cell cell = findCell(x, z);
+    float h00 = sample(cell.i, cell.k);
+    float h10 = sample(cell.i + 1, cell.k);
+    float h01 = sample(cell.i, cell.k + 1);
+    float h11 = sample(cell.i + 1, cell.k + 1);
+
+    // gradient of the bilinear patch
+    float dhdx = glm::mix(h10 - h00, h11 - h01, cell.t) / m_spacing.x;
+    float dhdz = glm::mix(h01 - h00, h11 - h10, cell.s) / m_spacing.y;
+
+    return glm::normalize(glm::vec3(-dhdx, 1.0f, -dhdz));
+}
+
+bool Heightfield::findContact(const glm::vec3& p, glm::vec3& normal, float& depth) const
+{
+    if (!contains(p.x, p.z)) return false;
+
+    float height = getHeight(p.x, p.z);
+    if (p.y >= height) return false;
+
+    // distance to the tangent plane rather than the vertical gap, so steep
+    // slopes don't push particles out too far
+    normal = getNormal(p.x, p.z);
+    depth = (height - p.y) * normal.y;
+    return true;
+}
+
+bool Heightfield::raycast(const glm::vec3& origin, const glm::vec3& direction, float maxT, float& t, glm::vec3& normal) const
+{
+    // clip the ray to the box the surface lies in
+    glm::vec3 invDirection = 1.0f / direction;
+    glm::vec3 t0 = (m_min - origin) * invDirection;
+    glm::vec3 t1 = (m_max - origin) * invDirection;
+    glm::vec3 tNear = glm::min(t0, t1);
+    glm::vec3 tFar = glm::max(t0, t1);
+    float enter = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.0f));
+    float exit = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, maxT));
+    if (enter > exit) return false;
+
+    auto heightAbove = [&](float s) {
+        glm::vec3 p = origin + s * direction;
+        return p.y - getHeight(p.x, p.z);
+    };
+
+    // steps are half a cell of horizontal travel
+    float horizontal = glm::length(glm::vec2(direction.x, direction.z));
+    float step = 0.5f * std::min(m_spacing.x, m_spacing.y) / std::max(horizontal, 1e-6f);
+
+    float a = enter;
+    float fa = heightAbove(a);
+    if (fa <= 0.0f)
+    {
+        t = a;
+        normal = getNormal(origin.x + a * direction.x, origin.z + a * direction.z);
+        return true;
+    }
+
+    while (a < exit)
+    {
+        float b = std::min(a + step, exit);
+        float fb = heightAbove(b);
+        if (fb <= 0.0f)
+        {
+            for (int i = 0; i < 16; ++i)
+            {
+                float m = 0.5f * (a + b);
+                if (heightAbove(m) > 0.0f) a = m;
+                else b = m;
+            }
+
+            t = b;
+            normal = getNormal(origin.x + b * direction.x, origin.z + b * direction.z);
+            return true;
+        }
+        a = b;
+    }
+
+    return false;
+}
+
+void Heightfield::setupMesh()
+{
+    struct GridVertex
+    {
+        glm::vec3 position;
+        glm::vec3 normal;
+    };
+
+    std::vector<GridVertex> vertices;
+    vertices.reserve(m_heights.size());
+    for (int k = 0; k < m_numZ; ++k)
+    {
+        for (int i = 0; i < m_numX; ++i)
+        {
+            // central differences, one-sided at the border
+            int i0 = std::max(i - 1, 0);
+            int i1 = std::min(i + 1, m_numX - 1);
+            int k0 = std::max(k - 1, 0);
+            int k1 = std::min(k + 1, m_numZ - 1);
+            float dhdx = (sample(i1, k) - sample(i0, k)) / (static_cast<float>(i1 - i0) * m_spacing.x);
+            float dhdz = (sample(i, k1) - sample(i, k0)) / (static_cast<float>(k1 - k0) * m_spacing.y);
+
+            GridVertex vertex;
+            vertex.position = glm::vec3(
+                m_min.x + static_cast<float>(i) * m_spacing.x,
+                sample(i, k),
+                m_min.z + static_cast<float>(k) * m_spacing.y
+            );
+            vertex.normal = glm::normalize(glm::vec3(-dhdx, 1.0f, -dhdz));
+            vertices.push_back(vertex);
+        }
+    }
+
+    // two counter-clockwise triangles per cell, seen from above
+    std::vector<unsigned int> indices;
+    indices.reserve(static_cast<size_t>(m_numX - 1) * (m_numZ - 1) * 6);
+    for (int k = 0; k + 1 < m_numZ; ++k)
+    {
+        for (int i = 0; i + 1 < m_numX; ++i)
+        {
+            unsigned int i00 = static_cast<unsigned int>(k * m_numX + i);
+            unsigned int i10 = i00 + 1;
+            unsigned int i01 = i00 + static_cast<unsigned int>(m_numX);
+            unsigned int i11 = i01 + 1;
+
+            indices.insert(indices.end(), { i00, i01, i10, i10, i01, i11 });
+        }
+    }
+    m_numIndices = static_cast<GLsizei>(indices.size());
+
+    // the grid never changes, so it is uploaded once
+    glGenVertexArrays(1, &m_VAO);
+    glGenBuffers(1, &m_VBO);
+    glGenBuffers(1, &m_EBO);
+
+    glBindVertexArray(m_VAO);
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(GridVertex), vertices.data(), GL_STATIC_DRAW);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(GridVertex), (void*)offsetof(GridVertex, position));
+
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(GridVertex), (void*)offsetof(GridVertex, normal));
+
+    glBindVertexArray(0);
+}
+
+void Heightfield::render()
+{
+    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+
+    glm::vec3 lightDirection = glm::vec3(
+        1.0f,
+        0.5f,
+        0.0
+    );
+
+    m_shader.useProgram();
+    m_shader.setVec3("lightDir", lightDirection);
+
+    int projectionLoc = glGetUniformLocation(m_shader.getID(), "projection");
+    glUniformMatrix4fv(projectionLoc, 1, GL_FALSE, glm::value_ptr(m_transform.getProjectionMatrix()));
+
+    int viewLoc = glGetUniformLocation(m_shader.getID(), "view");
+    glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(m_transform.getViewMatrix()));
+
+    // the grid is laid out in world space already
+    int modelLoc = glGetUniformLocation(m_shader.getID(), "model");
+    glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(glm::mat4(1.0f)));
+
+    glBindVertexArray(m_VAO);
+    glDrawElements(GL_TRIANGLES, m_numIndices, GL_UNSIGNED_INT, 0);
+    glBindVertexArray(0);
+}
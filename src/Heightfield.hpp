@@ -0,0 +1,90 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include "Transform.hpp"
+#include "Shader.hpp"
+
+// Static terrain: a regular grid of heights over the xz-plane that is solid
+// below its surface. Height and normal lookups are a bilinear interpolation of
+// the four surrounding samples, so the cost doesn't depend on the grid size,
+// and the surface is drawn as a single indexed grid.
+class Heightfield
+{
+public:
+    // heights are numX * numZ samples in [0, 1], row by row along x, scaled
+    // to size.y; the grid spans origin to origin + size
+    Heightfield(
+        std::string name,
+        Transform transform,
+        Shader shader,
+        std::vector<float> heights,
+        int numX,
+        int numZ,
+        const glm::vec3& origin,
+        const glm::vec3& size
+    );
+    ~Heightfield();
+
+    Heightfield(const Heightfield&) = delete;
+    Heightfield& operator=(const Heightfield&) = delete;
+
+    // greyscale image (8 or 16 bit); an empty vector means loading failed
+    static std::vector<float> loadImage(const std::string& path, int& numX, int& numZ);
+    // numX * numZ native-endian 32 bit floats
+    static std::vector<float> loadRaw(const std::string& path, int numX, int numZ);
+
+    std::string getName() const { return m_name; }
+    Transform& getTransform() { return m_transform; }
+
+    const glm::vec3& getMin() const { return m_min; }
+    const glm::vec3& getMax() const { return m_max; }
+    int getNumX() const { return m_numX; }
+    int getNumZ() const { return m_numZ; }
+
+    bool contains(float x, float z) const;
+    float getHeight(float x, float z) const;
+    glm::vec3 getNormal(float x, float z) const;
+
+    // point below the surface, pushed out along the surface normal
+    bool findContact(const glm::vec3& p, glm::vec3& normal, float& depth) const;
+
+    // first point where the ray drops below the surface, found by marching
+    // half a grid cell at a time and refining the crossing by bisection
+    bool raycast(const glm::vec3& origin, const glm::vec3& direction, float maxT, float& t, glm::vec3& normal) const;
+
+    void render();
+
+private:
+    struct Cell
+    {
+        int i;
+        int k;
+        float s;
+        float t;
+    };
+
+    Cell findCell(float x, float z) const;
+    float sample(int i, int k) const { return m_heights[static_cast<size_t>(k) * m_numX + i]; }
+    void setupMesh();
+
+    std::string m_name;
+    Transform m_transform;
+    Shader m_shader;
+
+    std::vector<float> m_heights;
+    int m_numX;
+    int m_numZ;
+    glm::vec3 m_min;
+    glm::vec3 m_max;
+    glm::vec2 m_spacing;
+
+    GLuint m_VAO;
+    GLuint m_VBO;
+    GLuint m_EBO;
+    GLsizei m_numIndices;
+};
@@ -59,6 +59,10 @@ void DebugWindow::update(
     ImGui::Dummy(ImVec2(0.0f, 5.0f));
     ImGui::Text("Frame Duration: %.3f ms", static_cast<float>(frameDuration));
     ImGui::Text("FPS: %.1f", 1000.0f / static_cast<float>(frameDuration));
+    if (scene.getNumWorkerProcesses() > 0)
+    {
+        ImGui::Text("Worker Processes: %d", scene.getNumWorkerProcesses());
+    }
     ImGui::Separator();
 
     // camera
@@ -74,6 +78,13 @@ void DebugWindow::update(
         camera->resetPosition();
     }
 
+    ImGui::Text("Drag Particles [Right Mouse]");
+    updatePicking(scene);
+    if (scene.isDragging())
+    {
+        ImGui::Text("Dragging: %s", scene.getDraggedObject()->getName().c_str());
+    }
+
     ImGui::Separator();
 
     // external forces
@@ -98,12 +109,123 @@ void DebugWindow::update(
     bool& enableDistanceConstraints = scene.enableDistanceConstraints();
     ImGui::Checkbox("Enable Distance Constraints", &enableDistanceConstraints);
 
+    bool& enableBendingConstraints = scene.enableBendingConstraints();
+    ImGui::Checkbox("Enable Bending Constraints", &enableBendingConstraints);
+
     bool& enableVolumeConstraints = scene.enableVolumeConstraints();
     ImGui::Checkbox("Enable Volume Constraints", &enableVolumeConstraints);
 
     bool& enableEnvCollisionConstraints = scene.enableEnvCollisionConstraints();
     ImGui::Checkbox("Enable Env Collision Constraints", &enableEnvCollisionConstraints);
 
+    bool& enableEnvCollisionGrid = scene.enableEnvCollisionGrid();
+    ImGui::Checkbox("Enable Collision Grid", &enableEnvCollisionGrid);
+    ImGui::SameLine();
+    ImGui::Text("(%zu cell entries)", scene.getEnvCollisionGrid().getNumEntries());
+
+    bool& enableColliderBVH = scene.enableColliderBVH();
+    ImGui::Checkbox("Enable Collider BVH", &enableColliderBVH);
+
+    bool& enableColliderSDF = scene.enableColliderSDF();
+    ImGui::Checkbox("Enable Collider SDF", &enableColliderSDF);
+
+    bool& enableAnalyticColliders = scene.enableAnalyticColliders();
+    ImGui::Checkbox("Enable Analytic Colliders", &enableAnalyticColliders);
+
+    bool& enableConvexHullColliders = scene.enableConvexHullColliders();
+    ImGui::Checkbox("Enable Convex Hull Colliders", &enableConvexHullColliders);
+
+    bool& enableContactReuse = scene.enableContactReuse();
+    ImGui::Checkbox("Reuse Contacts Across Substeps", &enableContactReuse);
+
+    bool& enableContactVelocities = scene.enableContactVelocities();
+    ImGui::Checkbox("Enable Friction and Restitution", &enableContactVelocities);
+
+    bool& enableContinuousCollisions = scene.enableContinuousCollisions();
+    ImGui::Checkbox("Enable CCD", &enableContinuousCollisions);
+
+    bool& enableSoftBodyCollisions = scene.enableSoftBodyCollisions();
+    ImGui::Checkbox("Enable Soft Body Collisions", &enableSoftBodyCollisions);
+
+    // tearing and batching change or regroup the objects the worker slots
+    // hold, so they only run in-process
+    bool hasWorkerProcesses = scene.getNumWorkerProcesses() > 0;
+
+    bool& enableTearing = scene.enableTearing();
+    ImGui::BeginDisabled(hasWorkerProcesses);
+    ImGui::Checkbox("Enable Tearing", &enableTearing);
+    ImGui::EndDisabled();
+    if (hasWorkerProcesses)
+    {
+        ImGui::SameLine();
+        ImGui::TextDisabled("(off with worker processes)");
+    }
+
+    size_t numFluidParticles = 0;
+    for (const auto& fluid : scene.getFluids())
+    {
+        numFluidParticles += fluid->getNumParticles();
+    }
+    bool& enableFluids = scene.enableFluids();
+    ImGui::Checkbox("Enable Fluids", &enableFluids);
+    ImGui::SameLine();
+    ImGui::Text("(%zu particles)", numFluidParticles);
+
+    for (const auto& fluid : scene.getFluids())
+    {
+        std::string label = "##" + fluid->getName();
+        ImGui::Text("%s iterations", fluid->getName().c_str());
+        ImGui::SameLine();
+        ImGui::SliderInt((label + "Iterations").c_str(), &fluid->getSolverIterations(), 1, 10);
+
+        ImGui::Text("%s viscosity", fluid->getName().c_str());
+        ImGui::SameLine();
+        ImGui::SliderFloat((label + "Viscosity").c_str(), &fluid->getViscosity(), 0.0f, 0.1f);
+    }
+
+    size_t numClothParticles = 0;
+    for (const auto& cloth : scene.getCloths())
+    {
+        numClothParticles += cloth->getNumParticles();
+    }
+    bool& enableCloth = scene.enableCloth();
+    ImGui::Checkbox("Enable Cloth", &enableCloth);
+    ImGui::SameLine();
+    ImGui::Text("(%zu particles)", numClothParticles);
+
+    for (const auto& cloth : scene.getCloths())
+    {
+        std::string label = "##" + cloth->getName();
+        ImGui::Text("%s iterations", cloth->getName().c_str());
+        ImGui::SameLine();
+        ImGui::SliderInt((label + "Iterations").c_str(), &cloth->getSolverIterations(), 1, 20);
+
+        ImGui::Text("%s stretch compliance", cloth->getName().c_str());
+        ImGui::SameLine();
+        ImGui::SliderFloat((label + "Stretch").c_str(), &cloth->getStretchCompliance(), 0.0f, 0.001f, "%.6f");
+
+        ImGui::Text("%s shear compliance", cloth->getName().c_str());
+        ImGui::SameLine();
+        ImGui::SliderFloat((label + "Shear").c_str(), &cloth->getShearCompliance(), 0.0f, 0.001f, "%.6f");
+    }
+
+    bool& enableInstanceBatching = scene.enableInstanceBatching();
+    ImGui::BeginDisabled(hasWorkerProcesses);
+    ImGui::Checkbox("Enable Instance Batching", &enableInstanceBatching);
+    ImGui::EndDisabled();
+    ImGui::SameLine();
+    if (hasWorkerProcesses)
+    {
+        ImGui::TextDisabled("(off with worker processes)");
+    }
+    else
+    {
+        ImGui::Text("(%zu batches)", scene.getNumInstanceBatches());
+    }
+
+    bool& enablePartitionedSolve = scene.enablePartitionedSolve();
+    ImGui::Checkbox("Enable Partitioned Solve", &enablePartitionedSolve);
+
     ImGui::Dummy(ImVec2(0.0f, 5.0f));
 
     float& alpha = scene.getAlpha();
@@ -113,10 +235,45 @@ void DebugWindow::update(
 
     ImGui::Dummy(ImVec2(0.0f, 5.0f));
 
+    float& bendingAlpha = scene.getBendingAlpha();
+    ImGui::Text("alpha bending");
+    ImGui::SameLine();
+    ImGui::SliderFloat("##alphaBending", &bendingAlpha, 0.0001f, 1.0f, "%.4f", ImGuiSliderFlags_Logarithmic);
+
+    ImGui::Dummy(ImVec2(0.0f, 5.0f));
+
     float& beta = scene.getBeta();
     ImGui::Text("beta");
     ImGui::SameLine();
     ImGui::SliderFloat("##beta", &beta, 1.0f, 10.0f);
+
+    ImGui::Dummy(ImVec2(0.0f, 5.0f));
+
+    float& tearStrain = scene.getTearStrain();
+    ImGui::Text("tear strain");
+    ImGui::SameLine();
+    ImGui::SliderFloat("##tearStrain", &tearStrain, 0.05f, 2.0f);
+
+    ImGui::Dummy(ImVec2(0.0f, 5.0f));
+
+    float& continuousCollisionThreshold = scene.getContinuousCollisionThreshold();
+    ImGui::Text("ccd threshold");
+    ImGui::SameLine();
+    ImGui::SliderFloat("##ccdThreshold", &continuousCollisionThreshold, 0.01f, 1.0f);
+
+    ImGui::Dummy(ImVec2(0.0f, 5.0f));
+
+    float& friction = scene.getFriction();
+    ImGui::Text("friction");
+    ImGui::SameLine();
+    ImGui::SliderFloat("##friction", &friction, 0.0f, 1.0f);
+
+    ImGui::Dummy(ImVec2(0.0f, 5.0f));
+
+    float& restitution = scene.getRestitution();
+    ImGui::Text("restitution");
+    ImGui::SameLine();
+    ImGui::SliderFloat("##restitution", &restitution, 0.0f, 1.0f);
     ImGui::Separator();
 
     ImGui::Dummy(ImVec2(0.0f, 5.0f));
@@ -136,10 +293,7 @@ void DebugWindow::update(
     ImGui::SameLine();
     if (ImGui::Button("Reset##ResetScene")  || ImGui::IsKeyPressed(ImGuiKey_R))
     {
-        for (auto& obj : scene.getObjects())
-        {
-            obj->resetVertexTransforms();
-        }
+        scene.resetObjects();
     }
 
     const std::vector<std::unique_ptr<Object>>& objects = scene.getObjects();
@@ -155,6 +309,32 @@ void DebugWindow::update(
 
         if (ImGui::CollapsingHeader(title.c_str()))
         {
+            if (!object->isStatic())
+            {
+                ImGui::Checkbox(("Self Collision##" + std::to_string(i)).c_str(), &object->enableSelfCollision());
+            }
+
+            const MeshPartition& partition = object->getMesh().partition;
+            if (!partition.empty() && ImGui::TreeNode(("Domains##" + std::to_string(i)).c_str()))
+            {
+                size_t numEdges = object->getMesh().distanceConstraints.edges.size();
+                ImGui::Text("Domains: %d", partition.numParts);
+                ImGui::Text("Edge Cut: %zu (%.1f%%)", partition.edgeCut, 100.0f * partition.edgeCut / numEdges);
+                ImGui::Text("Boundary Vertices: %zu", partition.boundaryVertices);
+                ImGui::Text("Load Imbalance: %.3f", partition.loadImbalance);
+                ImGui::Text("Disconnected Domains: %zu", partition.disconnectedParts);
+                for (int p = 0; p < partition.numParts; ++p)
+                {
+                    ImGui::BulletText(
+                        "Domain %d: %zu vertices, %zu constraints",
+                        p,
+                        partition.partSizes[p],
+                        partition.interiorConstraints[p].size()
+                    );
+                }
+
+                ImGui::TreePop();
+            }
 
             if (ImGui::TreeNode(("Vertex Transforms##" + std::to_string(i)).c_str()))
             {
@@ -204,4 +384,34 @@ void DebugWindow::update(
     }
 
     ImGui::End();
-}
\ No newline at end of file
+}
+
+void DebugWindow::updatePicking(Scene& scene)
+{
+    Camera* camera = scene.getCamera();
+    ImGuiIO& io = ImGui::GetIO();
+    glm::vec3 direction = camera->getPickDirection(io.MousePos.x, io.MousePos.y, io.DisplaySize.x, io.DisplaySize.y);
+
+    // grab the particle under the cursor and keep it at the same depth
+    if (ImGui::IsMouseClicked(ImGuiMouseButton_Right) && !io.WantCaptureMouse)
+    {
+        SceneQuery::Ray ray = { camera->getPosition(), direction, camera->getFarPlane() };
+        SceneQuery::Hit hit;
+        if (scene.getQuery().raycast(ray, hit) && hit.particle >= 0)
+        {
+            m_dragDistance = hit.distance;
+            scene.beginDrag(*hit.object, static_cast<unsigned int>(hit.particle), hit.point);
+        }
+    }
+    else if (scene.isDragging())
+    {
+        if (ImGui::IsMouseDown(ImGuiMouseButton_Right))
+        {
+            scene.moveDrag(camera->getPosition() + m_dragDistance * direction);
+        }
+        else
+        {
+            scene.endDrag();
+        }
+    }
+}
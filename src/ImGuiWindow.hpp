@@ -42,4 +42,10 @@ public:
         int frameDuration,
         Scene& scene
     );
+
+private:
+    void updatePicking(Scene& scene);
+
+    // distance along the pick ray the dragged particle is held at
+    float m_dragDistance = 0.0f;
 };
\ No newline at end of file
@@ -0,0 +1,517 @@
+#include "InstanceBatch.hpp"
+
+bool InstanceBatch::haveSameTopology(const Mesh& a, const Mesh& b)
+{
+    const auto& edgesA = a.distanceConstraints.edges;
+    const auto& edgesB = b.distanceConstraints.edges;
+    const auto& trianglesA = a.volumeConstraints.triangles;
+    const auto& trianglesB = b.volumeConstraints.triangles;
+
+    if (a.getNumPositions() != b.getNumPositions()) return false;
+    if (edgesA.size() != edgesB.size() || trianglesA.size() != trianglesB.size()) return false;
+    if (a.bendingConstraints.stencils.size() != b.bendingConstraints.stencils.size()) return false;
+
+    for (size_t j = 0; j < edgesA.size(); ++j)
+    {
+        if (edgesA[j].v1 != edgesB[j].v1 || edgesA[j].v2 != edgesB[j].v2) return false;
+    }
+
+    for (size_t j = 0; j < trianglesA.size(); ++j)
+    {
+        const Triangle& ta = trianglesA[j];
+        const Triangle& tb = trianglesB[j];
+        if (ta.v1 != tb.v1 || ta.v2 != tb.v2 || ta.v3 != tb.v3) return false;
+    }
+
+    return true;
+}
+
+void InstanceBatch::buildAffectedTriangles(const std::vector<Triangle>& triangles)
+{
+    // vertex -> incident triangles
+    std::vector<std::vector<unsigned int>> vertexTriangles(m_numVerts);
+    for (unsigned int t = 0; t < triangles.size(); ++t)
+    {
+        vertexTriangles[triangles[t].v1].push_back(t);
+        vertexTriangles[triangles[t].v2].push_back(t);
+        vertexTriangles[triangles[t].v3].push_back(t);
+    }
+
+    // union of the incident triangles of all three corners
+    m_affectedTriangleOffsets.assign(1, 0);
+    for (const auto& tri : triangles)
+    {
+        std::vector<unsigned int> affected;
+        for (unsigned int v : { tri.v1, tri.v2, tri.v3 })
+        {
+            affected.insert(affected.end(), vertexTriangles[v].begin(), vertexTriangles[v].end());
+        }
+        std::sort(affected.begin(), affected.end());
+        affected.erase(std::unique(affected.begin(), affected.end()), affected.end());
+
+        m_affectedTriangles.insert(m_affectedTriangles.end(), affected.begin(), affected.end());
+        m_affectedTriangleOffsets.push_back(static_cast<unsigned int>(m_affectedTriangles.size()));
+    }
+}
+
+InstanceBatch::InstanceBatch(const std::vector<Object*>& instances, float& k)
+    : m_instances(instances),
+      m_numLanes(instances.size()),
+      m_numVerts(instances.front()->getVertexTransforms().size()),
+      m_k(k)
+{
+    const Mesh& mesh = m_instances.front()->getMesh();
+    m_edges = mesh.distanceConstraints.edges;
+    m_triangles = mesh.volumeConstraints.triangles;
+    m_stencils = mesh.bendingConstraints.stencils;
+    buildAffectedTriangles(m_triangles);
+
+    const size_t L = m_numLanes;
+    for (size_t c = 0; c < 3; ++c)
+    {
+        m_x[c].assign(m_numVerts * L, 0.0f);
+        m_p[c].assign(m_numVerts * L, 0.0f);
+        m_posDiff[c].assign(m_numVerts * L, 0.0f);
+        m_v[c].assign(m_numVerts * L, 0.0f);
+        m_a[c].assign(m_numVerts * L, 0.0f);
+    }
+    m_w.assign(m_numVerts * L, 0.0f);
+    m_restLengths.assign(m_edges.size() * L, 0.0f);
+    m_bendingQ.assign(m_stencils.size() * 16 * L, 0.0f);
+    m_restBendingEnergies.assign(m_stencils.size() * L, 0.0f);
+    m_restVolumes.assign(L, 0.0f);
+    m_volumes.assign(L, 0.0f);
+
+    // rest data per instance (instances may differ in scale)
+    const float factor = 1.0f / 6.0f;
+    for (size_t lane = 0; lane < L; ++lane)
+    {
+        const Object& instance = *m_instances[lane];
+        const auto& rest = instance.getInitialVertexTransforms();
+        const auto& M = instance.getMass();
+
+        for (size_t v = 0; v < m_numVerts; ++v)
+        {
+            m_w[v * L + lane] = 1.0f / M[v];
+        }
+
+        for (size_t j = 0; j < m_edges.size(); ++j)
+        {
+            m_restLengths[j * L + lane] = glm::distance(
+                rest[m_edges[j].v1].getPosition(),
+                rest[m_edges[j].v2].getPosition()
+            );
+        }
+
+        std::vector<glm::vec3> restPositions(m_numVerts);
+        for (size_t v = 0; v < m_numVerts; ++v)
+        {
+            restPositions[v] = rest[v].getPosition();
+        }
+
+        for (size_t j = 0; j < m_stencils.size(); ++j)
+        {
+            std::array<float, 16> Q = Mesh::calculateBendingMatrix(m_stencils[j], restPositions);
+            for (size_t q = 0; q < 16; ++q)
+            {
+                m_bendingQ[(j * 16 + q) * L + lane] = Q[q];
+            }
+            m_restBendingEnergies[j * L + lane] = Mesh::calculateBendingEnergy(m_stencils[j], Q, restPositions);
+        }
+
+        float V_0 = 0.0f;
+        for (const auto& tri : m_triangles)
+        {
+            V_0 += factor * glm::dot(
+                glm::cross(rest[tri.v1].getPosition(), rest[tri.v2].getPosition()),
+                rest[tri.v3].getPosition()
+            );
+        }
+        m_restVolumes[lane] = V_0;
+    }
+
+    std::cout << "InstanceBatch created: " << L << " x " << mesh.getName() << '\n';
+}
+
+bool InstanceBatch::removeInstance(const Object* instance)
+{
+    auto it = std::find(m_instances.begin(), m_instances.end(), instance);
+    if (it == m_instances.end()) return false;
+
+    const size_t L = m_numLanes;
+    const size_t lane = static_cast<size_t>(it - m_instances.begin());
+
+    // every group of L lanes shrinks to L - 1 in place; a group's new slots
+    // never lie past its old ones, so each value is read before it is overwritten
+    auto removeLane = [L, lane](std::vector<float>& data) {
+        const size_t numGroups = data.size() / L;
+        for (size_t g = 0; g < numGroups; ++g)
+        {
+            const float last = data[g * L + L - 1];
+            for (size_t l = 0; l + 1 < L; ++l)
+            {
+                data[g * (L - 1) + l] = l == lane ? last : data[g * L + l];
+            }
+        }
+        data.resize(numGroups * (L - 1));
+    };
+
+    for (size_t c = 0; c < 3; ++c)
+    {
+        removeLane(m_x[c]);
+        removeLane(m_p[c]);
+        removeLane(m_posDiff[c]);
+        removeLane(m_v[c]);
+        removeLane(m_a[c]);
+    }
+    removeLane(m_w);
+    removeLane(m_restLengths);
+    removeLane(m_bendingQ);
+    removeLane(m_restBendingEnergies);
+    removeLane(m_restVolumes);
+    removeLane(m_volumes);
+
+    *it = m_instances.back();
+    m_instances.pop_back();
+    m_numLanes--;
+    return true;
+}
+
+void InstanceBatch::loadVertexTransforms()
+{
+    const size_t L = m_numLanes;
+    for (size_t lane = 0; lane < L; ++lane)
+    {
+        const auto& vertexTransforms = m_instances[lane]->getVertexTransforms();
+        for (size_t i = 0; i < m_numVerts; ++i)
+        {
+            const Transform& vertexTransform = vertexTransforms[i];
+            glm::vec3 x = vertexTransform.getPosition();
+            glm::vec3 v = vertexTransform.getVelocity();
+            glm::vec3 a = vertexTransform.getAcceleration();
+
+            size_t idx = i * L + lane;
+            for (int c = 0; c < 3; ++c)
+            {
+                m_x[c][idx] = x[c];
+                m_v[c][idx] = v[c];
+                m_a[c][idx] = a[c];
+            }
+        }
+    }
+}
+
+void InstanceBatch::storeVertexTransforms()
+{
+    const size_t L = m_numLanes;
+    for (size_t lane = 0; lane < L; ++lane)
+    {
+        auto& vertexTransforms = m_instances[lane]->getVertexTransforms();
+        for (size_t i = 0; i < m_numVerts; ++i)
+        {
+            size_t idx = i * L + lane;
+            vertexTransforms[i].setPosition(glm::vec3(m_x[0][idx], m_x[1][idx], m_x[2][idx]));
+            vertexTransforms[i].setVelocity(glm::vec3(m_v[0][idx], m_v[1][idx], m_v[2][idx]));
+        }
+    }
+}
+
+void InstanceBatch::predict(float deltaTime_s)
+{
+    const size_t N = m_numVerts * m_numLanes;
+    for (size_t c = 0; c < 3; ++c)
+    {
+        float* __restrict x = m_x[c].data();
+        float* __restrict p = m_p[c].data();
+        float* __restrict posDiff = m_posDiff[c].data();
+        float* __restrict v = m_v[c].data();
+        const float* __restrict a = m_a[c].data();
+
+        #pragma omp simd
+        for (size_t idx = 0; idx < N; ++idx)
+        {
+            v[idx] += deltaTime_s * a[idx];
+            p[idx] = x[idx];
+            x[idx] = p[idx] + deltaTime_s * v[idx];
+            posDiff[idx] = x[idx] - p[idx];
+        }
+    }
+}
+
+void InstanceBatch::gatherInstance(
+    size_t lane,
+    std::vector<glm::vec3>& x,
+    std::vector<glm::vec3>& posDiff
+) const
+{
+    const size_t L = m_numLanes;
+    x.resize(m_numVerts);
+    posDiff.resize(m_numVerts);
+    for (size_t i = 0; i < m_numVerts; ++i)
+    {
+        size_t idx = i * L + lane;
+        x[i] = glm::vec3(m_x[0][idx], m_x[1][idx], m_x[2][idx]);
+        posDiff[i] = glm::vec3(m_posDiff[0][idx], m_posDiff[1][idx], m_posDiff[2][idx]);
+    }
+}
+
+void InstanceBatch::scatterInstance(size_t lane, const std::vector<glm::vec3>& x)
+{
+    const size_t L = m_numLanes;
+    for (size_t i = 0; i < m_numVerts; ++i)
+    {
+        size_t idx = i * L + lane;
+        m_x[0][idx] = x[i].x;
+        m_x[1][idx] = x[i].y;
+        m_x[2][idx] = x[i].z;
+    }
+}
+
+void InstanceBatch::gatherVelocities(size_t lane, std::vector<glm::vec3>& v) const
+{
+    const size_t L = m_numLanes;
+    v.resize(m_numVerts);
+    for (size_t i = 0; i < m_numVerts; ++i)
+    {
+        size_t idx = i * L + lane;
+        v[i] = glm::vec3(m_v[0][idx], m_v[1][idx], m_v[2][idx]);
+    }
+}
+
+void InstanceBatch::scatterVelocities(size_t lane, const std::vector<glm::vec3>& v)
+{
+    const size_t L = m_numLanes;
+    for (size_t i = 0; i < m_numVerts; ++i)
+    {
+        size_t idx = i * L + lane;
+        m_v[0][idx] = v[i].x;
+        m_v[1][idx] = v[i].y;
+        m_v[2][idx] = v[i].z;
+    }
+}
+
+void InstanceBatch::solveDistanceConstraints(float alphaTilde, float gamma)
+{
+    const size_t L = m_numLanes;
+    float* __restrict xx = m_x[0].data();
+    float* __restrict xy = m_x[1].data();
+    float* __restrict xz = m_x[2].data();
+    const float* __restrict dx = m_posDiff[0].data();
+    const float* __restrict dy = m_posDiff[1].data();
+    const float* __restrict dz = m_posDiff[2].data();
+    const float* __restrict w = m_w.data();
+
+    for (size_t j = 0; j < m_edges.size(); ++j)
+    {
+        const size_t a = m_edges[j].v1 * L;
+        const size_t b = m_edges[j].v2 * L;
+        const float* __restrict d_0 = &m_restLengths[j * L];
+
+        #pragma omp simd
+        for (size_t lane = 0; lane < L; ++lane)
+        {
+            float ex = xx[a + lane] - xx[b + lane];
+            float ey = xy[a + lane] - xy[b + lane];
+            float ez = xz[a + lane] - xz[b + lane];
+            float length = std::sqrt(ex * ex + ey * ey + ez * ez);
+            float invLength = length > 0.0f ? 1.0f / length : 0.0f;
+            float nx = ex * invLength;
+            float ny = ey * invLength;
+            float nz = ez * invLength;
+
+            float C_j = length - d_0[lane];
+            float wa = w[a + lane];
+            float wb = w[b + lane];
+
+            float gradCPosDiff = nx * (dx[a + lane] - dx[b + lane])
+                               + ny * (dy[a + lane] - dy[b + lane])
+                               + nz * (dz[a + lane] - dz[b + lane]);
+            float deltaLambda = (-C_j - gamma * gradCPosDiff) / ((1 + gamma) * (wa + wb) + alphaTilde);
+
+            xx[a + lane] += deltaLambda * wa * nx;
+            xy[a + lane] += deltaLambda * wa * ny;
+            xz[a + lane] += deltaLambda * wa * nz;
+            xx[b + lane] -= deltaLambda * wb * nx;
+            xy[b + lane] -= deltaLambda * wb * ny;
+            xz[b + lane] -= deltaLambda * wb * nz;
+        }
+    }
+}
+
+void InstanceBatch::solveBendingConstraints(float alphaTilde, float gamma)
+{
+    const size_t L = m_numLanes;
+    float* __restrict xx = m_x[0].data();
+    float* __restrict xy = m_x[1].data();
+    float* __restrict xz = m_x[2].data();
+    const float* __restrict dx = m_posDiff[0].data();
+    const float* __restrict dy = m_posDiff[1].data();
+    const float* __restrict dz = m_posDiff[2].data();
+    const float* __restrict w = m_w.data();
+
+    for (size_t j = 0; j < m_stencils.size(); ++j)
+    {
+        const BendingStencil& stencil = m_stencils[j];
+        const size_t v[4] = { stencil.v1 * L, stencil.v2 * L, stencil.v3 * L, stencil.v4 * L };
+        const float* __restrict Q = &m_bendingQ[j * 16 * L];
+        const float* __restrict E_0 = &m_restBendingEnergies[j * L];
+
+        #pragma omp simd
+        for (size_t lane = 0; lane < L; ++lane)
+        {
+            // gradient is Q * x, energy is 0.5 * x^T Q x
+            float g[4][3];
+            float energy = 0.0f;
+            for (int a = 0; a < 4; ++a)
+            {
+                g[a][0] = g[a][1] = g[a][2] = 0.0f;
+                for (int b = 0; b < 4; ++b)
+                {
+                    float q = Q[(4 * a + b) * L + lane];
+                    g[a][0] += q * xx[v[b] + lane];
+                    g[a][1] += q * xy[v[b] + lane];
+                    g[a][2] += q * xz[v[b] + lane];
+                }
+                energy += g[a][0] * xx[v[a] + lane] + g[a][1] * xy[v[a] + lane] + g[a][2] * xz[v[a] + lane];
+            }
+
+            float C_j = 0.5f * energy - E_0[lane];
+            float gradCMInverseGradCT = 0.0f;
+            float gradCPosDiff = 0.0f;
+            for (int a = 0; a < 4; ++a)
+            {
+                size_t idx = v[a] + lane;
+                gradCMInverseGradCT += w[idx] * (g[a][0] * g[a][0] + g[a][1] * g[a][1] + g[a][2] * g[a][2]);
+                gradCPosDiff += g[a][0] * dx[idx] + g[a][1] * dy[idx] + g[a][2] * dz[idx];
+            }
+
+            float denominator = (1 + gamma) * gradCMInverseGradCT + alphaTilde;
+            float deltaLambda = denominator > 0.0f ? (-C_j - gamma * gradCPosDiff) / denominator : 0.0f;
+            for (int a = 0; a < 4; ++a)
+            {
+                size_t idx = v[a] + lane;
+                xx[idx] += deltaLambda * w[idx] * g[a][0];
+                xy[idx] += deltaLambda * w[idx] * g[a][1];
+                xz[idx] += deltaLambda * w[idx] * g[a][2];
+            }
+        }
+    }
+}
+
+void InstanceBatch::computeTripleProducts(unsigned int triangle, float* out) const
+{
+    const size_t L = m_numLanes;
+    const Triangle& tri = m_triangles[triangle];
+    const size_t a = tri.v1 * L;
+    const size_t b = tri.v2 * L;
+    const size_t c = tri.v3 * L;
+    const float* __restrict xx = m_x[0].data();
+    const float* __restrict xy = m_x[1].data();
+    const float* __restrict xz = m_x[2].data();
+
+    #pragma omp simd
+    for (size_t lane = 0; lane < L; ++lane)
+    {
+        float cx = xy[a + lane] * xz[b + lane] - xz[a + lane] * xy[b + lane];
+        float cy = xz[a + lane] * xx[b + lane] - xx[a + lane] * xz[b + lane];
+        float cz = xx[a + lane] * xy[b + lane] - xy[a + lane] * xx[b + lane];
+        out[lane] += (cx * xx[c + lane] + cy * xy[c + lane] + cz * xz[c + lane]) / 6.0f;
+    }
+}
+
+void InstanceBatch::solveVolumeConstraints(float alphaTilde, float gamma)
+{
+    const size_t L = m_numLanes;
+    const float factor = 1.0f / 6.0f;
+
+    // current volume per instance, kept up to date incrementally below
+    std::fill(m_volumes.begin(), m_volumes.end(), 0.0f);
+    for (unsigned int t = 0; t < m_triangles.size(); ++t)
+    {
+        computeTripleProducts(t, m_volumes.data());
+    }
+
+    std::vector<float> before(L), after(L);
+    float* __restrict xx = m_x[0].data();
+    float* __restrict xy = m_x[1].data();
+    float* __restrict xz = m_x[2].data();
+    const float* __restrict dx = m_posDiff[0].data();
+    const float* __restrict dy = m_posDiff[1].data();
+    const float* __restrict dz = m_posDiff[2].data();
+    const float* __restrict w = m_w.data();
+
+    for (unsigned int j = 0; j < m_triangles.size(); ++j)
+    {
+        const Triangle& tri = m_triangles[j];
+        const size_t v[3] = { tri.v1 * L, tri.v2 * L, tri.v3 * L };
+
+        std::fill(before.begin(), before.end(), 0.0f);
+        for (unsigned int k = m_affectedTriangleOffsets[j]; k < m_affectedTriangleOffsets[j + 1]; ++k)
+        {
+            computeTripleProducts(m_affectedTriangles[k], before.data());
+        }
+
+        #pragma omp simd
+        for (size_t lane = 0; lane < L; ++lane)
+        {
+            float n[3][3];
+            for (int i = 0; i < 3; ++i)
+            {
+                // gradient w.r.t. corner i is factor * cross(x_{i+1}, x_{i+2})
+                size_t p = v[(i + 1) % 3] + lane;
+                size_t q = v[(i + 2) % 3] + lane;
+                n[i][0] = factor * (xy[p] * xz[q] - xz[p] * xy[q]);
+                n[i][1] = factor * (xz[p] * xx[q] - xx[p] * xz[q]);
+                n[i][2] = factor * (xx[p] * xy[q] - xy[p] * xx[q]);
+            }
+
+            float C_j = m_volumes[lane] - m_k * m_restVolumes[lane];
+            float gradCMInverseGradCT = 0.0f;
+            float gradCPosDiff = 0.0f;
+            for (int i = 0; i < 3; ++i)
+            {
+                size_t idx = v[i] + lane;
+                gradCMInverseGradCT += w[idx] * (n[i][0] * n[i][0] + n[i][1] * n[i][1] + n[i][2] * n[i][2]);
+                gradCPosDiff += n[i][0] * dx[idx] + n[i][1] * dy[idx] + n[i][2] * dz[idx];
+            }
+
+            float deltaLambda = (-C_j - gamma * gradCPosDiff) / ((1 + gamma) * gradCMInverseGradCT + alphaTilde);
+            for (int i = 0; i < 3; ++i)
+            {
+                size_t idx = v[i] + lane;
+                xx[idx] += deltaLambda * w[idx] * n[i][0];
+                xy[idx] += deltaLambda * w[idx] * n[i][1];
+                xz[idx] += deltaLambda * w[idx] * n[i][2];
+            }
+        }
+
+        std::fill(after.begin(), after.end(), 0.0f);
+        for (unsigned int k = m_affectedTriangleOffsets[j]; k < m_affectedTriangleOffsets[j + 1]; ++k)
+        {
+            computeTripleProducts(m_affectedTriangles[k], after.data());
+        }
+
+        #pragma omp simd
+        for (size_t lane = 0; lane < L; ++lane)
+        {
+            m_volumes[lane] += after[lane] - before[lane];
+        }
+    }
+}
+
+void InstanceBatch::updateVelocities(float deltaTime_s)
+{
+    const size_t N = m_numVerts * m_numLanes;
+    for (size_t c = 0; c < 3; ++c)
+    {
+        const float* __restrict x = m_x[c].data();
+        const float* __restrict p = m_p[c].data();
+        float* __restrict v = m_v[c].data();
+
+        #pragma omp simd
+        for (size_t idx = 0; idx < N; ++idx)
+        {
+            v[idx] = (x[idx] - p[idx]) / deltaTime_s;
+        }
+    }
+}
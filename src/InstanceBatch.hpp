@@ -0,0 +1,75 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <algorithm>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "Object.hpp"
+
+// Groups non-static objects that share the same constraint topology so their
+// distance and volume constraints can be solved in one sweep. Particle state is
+// interleaved per vertex (index = vertex * numLanes + lane), so every lane of the
+// inner loop processes the same constraint for a different instance.
+class InstanceBatch
+{
+public:
+    InstanceBatch(const std::vector<Object*>& instances, float& k);
+
+    static bool haveSameTopology(const Mesh& a, const Mesh& b);
+
+    const std::vector<Object*>& getInstances() const { return m_instances; }
+    size_t getNumLanes() const { return m_numLanes; }
+
+    // the last lane takes the removed instance's place; false if it isn't batched here
+    bool removeInstance(const Object* instance);
+
+    // particle state stays in the lanes for the whole frame; the vertex
+    // transforms are read at its start and written at its end
+    void loadVertexTransforms();
+    void storeVertexTransforms();
+
+    void predict(float deltaTime_s);
+    void gatherInstance(size_t lane, std::vector<glm::vec3>& x, std::vector<glm::vec3>& posDiff) const;
+    void scatterInstance(size_t lane, const std::vector<glm::vec3>& x);
+    void gatherVelocities(size_t lane, std::vector<glm::vec3>& v) const;
+    void scatterVelocities(size_t lane, const std::vector<glm::vec3>& v);
+
+    void solveDistanceConstraints(float alphaTilde, float gamma);
+    void solveBendingConstraints(float alphaTilde, float gamma);
+    void solveVolumeConstraints(float alphaTilde, float gamma);
+
+    void updateVelocities(float deltaTime_s);
+
+private:
+    void buildAffectedTriangles(const std::vector<Triangle>& triangles);
+    void computeTripleProducts(unsigned int triangle, float* out) const;
+
+private:
+    std::vector<Object*> m_instances;
+    size_t m_numLanes;
+    size_t m_numVerts;
+    float& m_k;
+
+    std::vector<Edge> m_edges;
+    std::vector<Triangle> m_triangles;
+    std::vector<BendingStencil> m_stencils;
+
+    // triangles whose volume contribution changes when triangle j moves (CSR)
+    std::vector<unsigned int> m_affectedTriangleOffsets;
+    std::vector<unsigned int> m_affectedTriangles;
+
+    // interleaved per-lane data
+    std::array<std::vector<float>, 3> m_x;
+    std::array<std::vector<float>, 3> m_p;
+    std::array<std::vector<float>, 3> m_posDiff;
+    std::array<std::vector<float>, 3> m_v;
+    std::array<std::vector<float>, 3> m_a;
+    std::vector<float> m_w;
+    std::vector<float> m_restLengths;
+    std::vector<float> m_bendingQ;
+    std::vector<float> m_restBendingEnergies;
+    std::vector<float> m_restVolumes;
+    std::vector<float> m_volumes;
+};
@@ -1,6 +1,33 @@
 #include "Mesh.hpp"
 #include "Object.hpp"
 
+#include <filesystem>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// bump the version whenever what loadObjData builds changes
+static constexpr uint32_t XMeshFileMagic = 0x48534d58; // "XMSH"
+static constexpr uint32_t XMeshFileVersion = 1;
+
+namespace
+{
+    struct XMeshHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t key;
+        uint64_t numVertices;
+        uint64_t numIndices;
+        uint64_t numPositions;
+        uint64_t numEdges;
+        uint64_t numStencils;
+        uint64_t numTriangles;
+        uint64_t numEnvCollisionVertices;
+    };
+}
+
 void Mesh::constructVertices(const aiMesh* mesh)
 {
     for (size_t i = 0; i < mesh->mNumVertices; ++i)
@@ -14,19 +41,6 @@ void Mesh::constructVertices(const aiMesh* mesh)
         vector.z = mesh->mVertices[i].z;
         vertex.position = vector;
 
-        // Keep track of only unique vertex positions
-        auto pit = std::find(m_positions.begin(), m_positions.end(), vertex.position);
-        if (pit == m_positions.end())
-        {
-            m_positions.push_back(vertex.position);
-            m_duplicatePositionIndices.push_back({static_cast<unsigned int>(i)});
-        }
-        else
-        {
-            size_t pidx = std::distance(m_positions.begin(), pit);
-            m_duplicatePositionIndices[pidx].push_back(i);
-        }
-
         // Vertex texture coordinates
         if(mesh->mTextureCoords[0])
         {
@@ -50,6 +64,94 @@ void Mesh::constructVertices(const aiMesh* mesh)
     }
 }
 
+void Mesh::weldPositions(float epsilon)
+{
+    // render vertices are hashed by cell, so every vertex only compares
+    // against the positions already found in its own and adjacent cells
+    struct Cell
+    {
+        int x;
+        int y;
+        int z;
+        bool operator==(const Cell& other) const
+        {
+            return x == other.x && y == other.y && z == other.z;
+        }
+    };
+    struct CellHash
+    {
+        size_t operator()(const Cell& c) const
+        {
+            return (static_cast<uint32_t>(c.x) * 73856093u) ^
+                   (static_cast<uint32_t>(c.y) * 19349663u) ^
+                   (static_cast<uint32_t>(c.z) * 83492791u);
+        }
+    };
+
+    // without an epsilon the cell is the position's bit pattern, and the
+    // sum turns -0 into +0 so they weld like std::find did
+    auto toCell = [epsilon](const glm::vec3& p) {
+        if (epsilon > 0.0f)
+        {
+            glm::ivec3 c = glm::ivec3(glm::floor(p / epsilon));
+            return Cell{ c.x, c.y, c.z };
+        }
+        glm::vec3 q = p + glm::vec3(0.0f);
+        Cell c;
+        std::memcpy(&c.x, &q.x, sizeof(float));
+        std::memcpy(&c.y, &q.y, sizeof(float));
+        std::memcpy(&c.z, &q.z, sizeof(float));
+        return c;
+    };
+    const int range = epsilon > 0.0f ? 1 : 0;
+    const float epsilon2 = epsilon * epsilon;
+
+    std::unordered_map<Cell, std::vector<unsigned int>, CellHash> cells;
+    cells.reserve(m_vertices.size());
+
+    m_positions.clear();
+    m_vertexPositionIndices.resize(m_vertices.size());
+    for (size_t i = 0; i < m_vertices.size(); ++i)
+    {
+        const glm::vec3& position = m_vertices[i].position;
+        Cell cell = toCell(position);
+
+        int found = -1;
+        for (int dx = -range; dx <= range && found < 0; ++dx)
+        {
+            for (int dy = -range; dy <= range && found < 0; ++dy)
+            {
+                for (int dz = -range; dz <= range && found < 0; ++dz)
+                {
+                    auto it = cells.find(Cell{ cell.x + dx, cell.y + dy, cell.z + dz });
+                    if (it == cells.end()) continue;
+
+                    for (unsigned int p : it->second)
+                    {
+                        glm::vec3 d = m_positions[p] - position;
+                        if (epsilon > 0.0f ? glm::dot(d, d) <= epsilon2 : m_positions[p] == position)
+                        {
+                            found = static_cast<int>(p);
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+
+        // the first vertex at a position defines it
+        if (found < 0)
+        {
+            found = static_cast<int>(m_positions.size());
+            m_positions.push_back(position);
+            cells[cell].push_back(static_cast<unsigned int>(found));
+        }
+        m_vertexPositionIndices[i] = static_cast<unsigned int>(found);
+    }
+
+    m_duplicatePositionIndices.buildInverse(m_positions.size(), m_vertexPositionIndices);
+}
+
 void Mesh::constructIndices(const aiMesh* mesh)
 {
     for(size_t i = 0; i < mesh->mNumFaces; i++)
@@ -70,22 +172,10 @@ std::vector<Triangle> Mesh::constructTriangles()
     // Process triangles directly from m_indices
     for (size_t i = 0; i + 2 < m_indices.size(); i += 3)
     {
-        // Get position indices for each vertex in the triangle
-        unsigned int posIndices[3];
-        for (int j = 0; j < 3; ++j)
-        {
-            unsigned int vertexIdx = m_indices[i + j];
-            const glm::vec3& pos = m_vertices[vertexIdx].position;
-
-            // Find this position in m_positions
-            auto it = std::find(m_positions.begin(), m_positions.end(), pos);
-            posIndices[j] = static_cast<unsigned int>(std::distance(m_positions.begin(), it));
-        }
-
         Triangle tri;
-        tri.v1 = posIndices[0];
-        tri.v2 = posIndices[1];
-        tri.v3 = posIndices[2];
+        tri.v1 = m_vertexPositionIndices[m_indices[i]];
+        tri.v2 = m_vertexPositionIndices[m_indices[i + 1]];
+        tri.v3 = m_vertexPositionIndices[m_indices[i + 2]];
         triangles.push_back(tri);
     }
 
@@ -133,7 +223,8 @@ void Mesh::constructDistanceConstraintVertices()
         }
     };
 
-    std::set<UniqueEdge> uniqueEdges;
+    // unique edges with the opposite vertex of every triangle sharing them
+    std::map<UniqueEdge, std::vector<unsigned int>> uniqueEdges;
 
     // Process triangles directly from m_indices
     for (size_t i = 0; i + 2 < m_indices.size(); i += 3)
@@ -142,27 +233,33 @@ void Mesh::constructDistanceConstraintVertices()
         unsigned int idx[3];
         for (int j = 0; j < 3; ++j)
         {
-            unsigned int vertexIdx = m_indices[i + j];
-            const glm::vec3& pos = m_vertices[vertexIdx].position;
-
-            // Find this position in m_positions
-            auto it = std::find(m_positions.begin(), m_positions.end(), pos);
-            idx[j] = static_cast<unsigned int>(std::distance(m_positions.begin(), it));
+            idx[j] = m_vertexPositionIndices[m_indices[i + j]];
         }
 
         // Add three edges for this triangle
-        uniqueEdges.insert(UniqueEdge{idx[0], idx[1]});
-        uniqueEdges.insert(UniqueEdge{idx[1], idx[2]});
-        uniqueEdges.insert(UniqueEdge{idx[2], idx[0]});
+        uniqueEdges[UniqueEdge{idx[0], idx[1]}].push_back(idx[2]);
+        uniqueEdges[UniqueEdge{idx[1], idx[2]}].push_back(idx[0]);
+        uniqueEdges[UniqueEdge{idx[2], idx[0]}].push_back(idx[1]);
     }
 
     // Create edges from unique pairs
-    for (const auto& e : uniqueEdges)
+    for (const auto& [e, opposites] : uniqueEdges)
     {
         Edge edge;
         edge.v1 = e.v1;
         edge.v2 = e.v2;
         distanceConstraints.edges.push_back(edge);
+
+        // Interior edges shared by exactly two triangles get a bending stencil
+        if (opposites.size() == 2 && opposites[0] != opposites[1])
+        {
+            BendingStencil stencil;
+            stencil.v1 = e.v1;
+            stencil.v2 = e.v2;
+            stencil.v3 = opposites[0];
+            stencil.v4 = opposites[1];
+            bendingConstraints.stencils.push_back(stencil);
+        }
     }
 }
 
@@ -174,31 +271,202 @@ void Mesh::constructVolumeConstraintVertices()
 
 void Mesh::constructEnvCollisionConstraintVertices()
 {
-    std::set<unsigned int> uniqueIndices;
+    // every position used by a render vertex, in position order
+    std::vector<bool> used(m_positions.size(), false);
+    for (unsigned int p : m_vertexPositionIndices)
+    {
+        used[p] = true;
+    }
 
-    // Directly iterate through m_vertices
-    for (size_t i = 0; i < m_vertices.size(); ++i)
+    for (size_t p = 0; p < used.size(); ++p)
     {
-        const glm::vec3& pos = m_vertices[i].position;
+        if (used[p]) envCollisionConstraintVertices.push_back(static_cast<unsigned int>(p));
+    }
+}
 
-        // Find in m_positions
-        auto it = std::find(m_positions.begin(), m_positions.end(), pos);
-        if (it != m_positions.end())
+uint64_t Mesh::calculateCacheKey(const std::string& meshPath, float weldEpsilon)
+{
+    std::ifstream file(meshPath, std::ios::binary);
+    if (!file) return 0;
+    std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    // FNV-1a
+    uint64_t hash = 14695981039346656037ull;
+    auto mix = [&](const void* data, size_t size) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; ++i)
         {
-            unsigned int idx = static_cast<unsigned int>(std::distance(m_positions.begin(), it));
-            uniqueIndices.insert(idx);
+            hash ^= bytes[i];
+            hash *= 1099511628211ull;
         }
+    };
+
+    // the record layouts are part of the key, so a build whose structs differ
+    // never reads another build's cache
+    const size_t recordSizes[] = {
+        sizeof(XMeshHeader), sizeof(Vertex), sizeof(glm::vec3),
+        sizeof(Edge), sizeof(BendingStencil), sizeof(Triangle)
+    };
+
+    mix(&XMeshFileMagic, sizeof(XMeshFileMagic));
+    mix(&XMeshFileVersion, sizeof(XMeshFileVersion));
+    mix(recordSizes, sizeof(recordSizes));
+    mix(content.data(), content.size());
+    mix(&weldEpsilon, sizeof(weldEpsilon));
+    return hash;
+}
+
+bool Mesh::saveCache(const std::string& path, uint64_t key) const
+{
+    std::ofstream file(path, std::ios::binary);
+    if (!file)
+    {
+        std::cerr << "Mesh: could not write " << path << std::endl;
+        return false;
     }
 
-    envCollisionConstraintVertices.insert(
-        envCollisionConstraintVertices.end(),
-        uniqueIndices.begin(),
-        uniqueIndices.end()
-    );
+    XMeshHeader header = {
+        XMeshFileMagic,
+        XMeshFileVersion,
+        key,
+        m_vertices.size(),
+        m_indices.size(),
+        m_positions.size(),
+        distanceConstraints.edges.size(),
+        bendingConstraints.stencils.size(),
+        volumeConstraints.triangles.size(),
+        envCollisionConstraintVertices.size()
+    };
+
+    auto write = [&file](const auto& values) {
+        file.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(values[0]));
+    };
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    write(m_vertices);
+    write(m_indices);
+    write(m_positions);
+    write(m_vertexPositionIndices);
+    write(distanceConstraints.edges);
+    write(bendingConstraints.stencils);
+    write(volumeConstraints.triangles);
+    write(envCollisionConstraintVertices);
+    return static_cast<bool>(file);
 }
 
-void Mesh::loadObjData(const std::string& filePath)
+bool Mesh::loadCache(const std::string& path, uint64_t key)
 {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat status;
+    if (fstat(fd, &status) != 0 || static_cast<size_t>(status.st_size) < sizeof(XMeshHeader))
+    {
+        close(fd);
+        return false;
+    }
+
+    // the sections are copied straight out of the mapping
+    size_t size = static_cast<size_t>(status.st_size);
+    void* memory = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (memory == MAP_FAILED) return false;
+
+    const char* data = static_cast<const char*>(memory);
+    XMeshHeader header;
+    std::memcpy(&header, data, sizeof(header));
+
+    // every section must fit in what is left of the file; dividing instead of
+    // multiplying keeps a corrupt count from overflowing the size check
+    size_t remaining = size - sizeof(header);
+    auto fits = [&remaining](uint64_t count, size_t recordSize) {
+        if (count > remaining / recordSize) return false;
+        remaining -= count * recordSize;
+        return true;
+    };
+
+    bool valid = header.magic == XMeshFileMagic &&
+                 header.version == XMeshFileVersion &&
+                 header.key == key &&
+                 fits(header.numVertices, sizeof(Vertex)) &&
+                 fits(header.numIndices, sizeof(unsigned int)) &&
+                 fits(header.numPositions, sizeof(glm::vec3)) &&
+                 fits(header.numVertices, sizeof(unsigned int)) &&
+                 fits(header.numEdges, sizeof(Edge)) &&
+                 fits(header.numStencils, sizeof(BendingStencil)) &&
+                 fits(header.numTriangles, sizeof(Triangle)) &&
+                 fits(header.numEnvCollisionVertices, sizeof(unsigned int)) &&
+                 remaining == 0;
+    if (valid)
+    {
+        const char* cursor = data + sizeof(header);
+        auto read = [&cursor](auto& values, uint64_t count) {
+            values.resize(count);
+            std::memcpy(values.data(), cursor, count * sizeof(values[0]));
+            cursor += count * sizeof(values[0]);
+        };
+
+        read(m_vertices, header.numVertices);
+        read(m_indices, header.numIndices);
+        read(m_positions, header.numPositions);
+        read(m_vertexPositionIndices, header.numVertices);
+        read(distanceConstraints.edges, header.numEdges);
+        read(bendingConstraints.stencils, header.numStencils);
+        read(volumeConstraints.triangles, header.numTriangles);
+        read(envCollisionConstraintVertices, header.numEnvCollisionVertices);
+
+        // indices are used unchecked later on, so one out of range rejects the cache
+        const uint64_t numVertices = header.numVertices;
+        const uint64_t numPositions = header.numPositions;
+        auto inRange = [](const auto& values, uint64_t limit) {
+            return std::all_of(values.begin(), values.end(), [limit](unsigned int i) { return i < limit; });
+        };
+
+        valid = inRange(m_indices, numVertices) &&
+                inRange(m_vertexPositionIndices, numPositions) &&
+                inRange(envCollisionConstraintVertices, numPositions) &&
+                std::all_of(distanceConstraints.edges.begin(), distanceConstraints.edges.end(), [&](const Edge& e) {
+                    return e.v1 < numPositions && e.v2 < numPositions;
+                }) &&
+                std::all_of(bendingConstraints.stencils.begin(), bendingConstraints.stencils.end(), [&](const BendingStencil& b) {
+                    return b.v1 < numPositions && b.v2 < numPositions && b.v3 < numPositions && b.v4 < numPositions;
+                }) &&
+                std::all_of(volumeConstraints.triangles.begin(), volumeConstraints.triangles.end(), [&](const Triangle& t) {
+                    return t.v1 < numPositions && t.v2 < numPositions && t.v3 < numPositions;
+                });
+
+        if (!valid)
+        {
+            std::cerr << "Mesh: ignoring cache with out of range indices " << path << std::endl;
+            m_vertices.clear();
+            m_indices.clear();
+            m_positions.clear();
+            m_vertexPositionIndices.clear();
+            distanceConstraints.edges.clear();
+            bendingConstraints.stencils.clear();
+            volumeConstraints.triangles.clear();
+            envCollisionConstraintVertices.clear();
+        }
+    }
+
+    munmap(memory, size);
+    return valid;
+}
+
+void Mesh::loadObjData(const std::string& filePath, float weldEpsilon)
+{
+    uint64_t key = calculateCacheKey(filePath, weldEpsilon);
+    std::ostringstream cachePath;
+    cachePath << "../res/cache/mesh/" << std::hex << key << ".xmesh";
+
+    // the flat tables are rebuilt from the cached arrays in linear time
+    if (key != 0 && loadCache(cachePath.str(), key))
+    {
+        m_duplicatePositionIndices.buildInverse(m_positions.size(), m_vertexPositionIndices);
+        constructAdjacency();
+        return;
+    }
+
     Assimp::Importer importer;
     const aiScene* scene = importer.ReadFile(
         filePath,
@@ -215,12 +483,59 @@ void Mesh::loadObjData(const std::string& filePath)
 
     // Construct m_vertices and m_indices
     constructVertices(mesh);
+    weldPositions(weldEpsilon);
     constructIndices(mesh);
 
     // construct vertices used for specific constraints
     constructDistanceConstraintVertices();
     constructVolumeConstraintVertices();
     constructEnvCollisionConstraintVertices();
+    constructAdjacency();
+
+    if (key != 0)
+    {
+        std::error_code error;
+        std::filesystem::create_directories(std::filesystem::path(cachePath.str()).parent_path(), error);
+        if (saveCache(cachePath.str(), key))
+        {
+            std::cout << "Mesh cached: " << filePath << " -> " << cachePath.str() << std::endl;
+        }
+    }
+}
+
+void Mesh::constructAdjacency()
+{
+    size_t n = m_positions.size();
+
+    const auto& triangles = volumeConstraints.triangles;
+    m_vertexTriangles.build(n, [&triangles](auto emit) {
+        for (unsigned int t = 0; t < triangles.size(); ++t)
+        {
+            emit(triangles[t].v1, t);
+            emit(triangles[t].v2, t);
+            emit(triangles[t].v3, t);
+        }
+    });
+
+    const auto& edges = distanceConstraints.edges;
+    m_vertexEdges.build(n, [&edges](auto emit) {
+        for (unsigned int j = 0; j < edges.size(); ++j)
+        {
+            emit(edges[j].v1, j);
+            emit(edges[j].v2, j);
+        }
+    });
+
+    const auto& stencils = bendingConstraints.stencils;
+    m_vertexStencils.build(n, [&stencils](auto emit) {
+        for (unsigned int j = 0; j < stencils.size(); ++j)
+        {
+            for (unsigned int v : { stencils[j].v1, stencils[j].v2, stencils[j].v3, stencils[j].v4 })
+            {
+                emit(v, j);
+            }
+        }
+    });
 }
 
 void Mesh::setCandidateObjectMeshes(const std::vector<Object*>& objects)
@@ -240,21 +555,169 @@ void Mesh::setCandidateObjectMeshes(const std::vector<Object*>& objects)
 
 void Mesh::constructDistanceConstraints()
 {
-    for (const auto& edge : distanceConstraints.edges)
+    // rest shape for constraints created later on, e.g. when tearing
+    m_restPositions = m_positions;
+
+    for (size_t j = 0; j < distanceConstraints.edges.size(); ++j)
+    {
+        assignDistanceConstraint(j);
+    }
+}
+
+void Mesh::assignDistanceConstraint(size_t j)
+{
+    unsigned int v1 = distanceConstraints.edges[j].v1;
+    unsigned int v2 = distanceConstraints.edges[j].v2;
+    float d_0 = glm::distance(m_restPositions[v1], m_restPositions[v2]);
+
+    if (j >= distanceConstraints.C.size())
+    {
+        distanceConstraints.C.resize(j + 1);
+        distanceConstraints.gradC.resize(j + 1);
+    }
+
+    distanceConstraints.C[j] = [=](const std::vector<glm::vec3>& x) -> float {
+        return glm::distance(x[v1], x[v2]) - d_0;
+    };
+
+    distanceConstraints.gradC[j] = [=](const std::vector<glm::vec3>& x) -> std::vector<glm::vec3> {
+        glm::vec3 n = (x[v1] - x[v2]) / glm::distance(x[v1], x[v2]);
+        return { n, -n };
+    };
+}
+
+static float cotTheta(const glm::vec3& a, const glm::vec3& b)
+{
+    float cosTheta = glm::dot(a, b);
+    float sinTheta = glm::length(glm::cross(a, b));
+    return cosTheta / std::max(sinTheta, 1e-8f);
+}
+
+std::array<float, 16> Mesh::calculateBendingMatrix(
+    const BendingStencil& stencil,
+    const std::vector<glm::vec3>& x
+)
+{
+    // isometric bending (Bergou et al. 2006): x0, x1 span the shared edge and
+    // x2, x3 are the opposite vertices of the two triangles
+    const glm::vec3& x0 = x[stencil.v1];
+    const glm::vec3& x1 = x[stencil.v2];
+    const glm::vec3& x2 = x[stencil.v3];
+    const glm::vec3& x3 = x[stencil.v4];
+
+    glm::vec3 e0 = x1 - x0;
+    glm::vec3 e1 = x2 - x0;
+    glm::vec3 e2 = x3 - x0;
+    glm::vec3 e3 = x2 - x1;
+    glm::vec3 e4 = x3 - x1;
+
+    float c01 = cotTheta(e0, e1);
+    float c02 = cotTheta(e0, e2);
+    float c03 = cotTheta(-e0, e3);
+    float c04 = cotTheta(-e0, e4);
+
+    float A0 = 0.5f * glm::length(glm::cross(e0, e1));
+    float A1 = 0.5f * glm::length(glm::cross(e0, e2));
+
+    float coef = -3.0f / (2.0f * (A0 + A1));
+    float K[4] = { c03 + c04, c01 + c02, -c01 - c03, -c02 - c04 };
+
+    std::array<float, 16> Q;
+    for (int i = 0; i < 4; ++i)
+    {
+        for (int j = 0; j < 4; ++j)
+        {
+            Q[4 * i + j] = coef * K[i] * K[j];
+        }
+    }
+    return Q;
+}
+
+float Mesh::calculateBendingEnergy(
+    const BendingStencil& stencil,
+    const std::array<float, 16>& Q,
+    const std::vector<glm::vec3>& x
+)
+{
+    const unsigned int v[4] = { stencil.v1, stencil.v2, stencil.v3, stencil.v4 };
+    float energy = 0.0f;
+    for (int i = 0; i < 4; ++i)
+    {
+        for (int j = 0; j < 4; ++j)
+        {
+            energy += Q[4 * i + j] * glm::dot(x[v[i]], x[v[j]]);
+        }
+    }
+    return 0.5f * energy;
+}
+
+void Mesh::constructBendingConstraints()
+{
+    for (size_t j = 0; j < bendingConstraints.stencils.size(); ++j)
+    {
+        assignBendingConstraint(j);
+    }
+}
+
+void Mesh::assignBendingConstraint(size_t j)
+{
+    const BendingStencil stencil = bendingConstraints.stencils[j];
+    std::array<float, 16> Q = calculateBendingMatrix(stencil, m_restPositions);
+
+    // the rest shape need not be flat, so measure against its own energy
+    float E_0 = calculateBendingEnergy(stencil, Q, m_restPositions);
+
+    if (j >= bendingConstraints.C.size())
+    {
+        bendingConstraints.C.resize(j + 1);
+        bendingConstraints.gradC.resize(j + 1);
+    }
+
+    bendingConstraints.C[j] = [=](const std::vector<glm::vec3>& x) -> float {
+        return calculateBendingEnergy(stencil, Q, x) - E_0;
+    };
+
+    // the gradient is linear in the positions: Q * x
+    bendingConstraints.gradC[j] = [=](const std::vector<glm::vec3>& x) -> std::vector<glm::vec3> {
+        const unsigned int v[4] = { stencil.v1, stencil.v2, stencil.v3, stencil.v4 };
+        std::vector<glm::vec3> grad(4, glm::vec3(0.0f));
+        for (int i = 0; i < 4; ++i)
+        {
+            for (int j = 0; j < 4; ++j)
+            {
+                grad[i] += Q[4 * i + j] * x[v[j]];
+            }
+        }
+        return grad;
+    };
+}
+
+void Mesh::removeBendingConstraint(size_t j)
+{
+    // swap with the last stencil and fix up that stencil's adjacency
+    size_t last = bendingConstraints.stencils.size() - 1;
+    const BendingStencil& removed = bendingConstraints.stencils[j];
+    for (unsigned int v : { removed.v1, removed.v2, removed.v3, removed.v4 })
     {
-        unsigned int v1 = edge.v1;
-        unsigned int v2 = edge.v2;
-        float d_0 = glm::distance(m_positions[v1], m_positions[v2]);
+        m_vertexStencils.erase(v, static_cast<unsigned int>(j));
+    }
 
-        distanceConstraints.C.push_back([=](const std::vector<glm::vec3>& x) -> float {
-            return glm::distance(x[v1], x[v2]) - d_0;
-        });
+    if (j != last)
+    {
+        const BendingStencil& moved = bendingConstraints.stencils[last];
+        for (unsigned int v : { moved.v1, moved.v2, moved.v3, moved.v4 })
+        {
+            m_vertexStencils.replace(v, static_cast<unsigned int>(last), static_cast<unsigned int>(j));
+        }
 
-        distanceConstraints.gradC.push_back([=](const std::vector<glm::vec3>& x) -> std::vector<glm::vec3> {
-            glm::vec3 n = (x[v1] - x[v2]) / glm::distance(x[v1], x[v2]);
-            return { n, -n };
-        });
+        bendingConstraints.stencils[j] = bendingConstraints.stencils[last];
+        bendingConstraints.C[j] = std::move(bendingConstraints.C[last]);
+        bendingConstraints.gradC[j] = std::move(bendingConstraints.gradC[last]);
     }
+
+    bendingConstraints.stencils.pop_back();
+    bendingConstraints.C.pop_back();
+    bendingConstraints.gradC.pop_back();
 }
 
 void Mesh::constructVolumeConstraints(float& k)
@@ -281,73 +744,332 @@ void Mesh::constructVolumeConstraints(float& k)
         return V - k * V_0;
     });
 
-    for (const auto& triangle : volumeConstraints.triangles)
+    for (size_t t = 0; t < volumeConstraints.triangles.size(); ++t)
     {
-        unsigned int v1 = triangle.v1;
-        unsigned int v2 = triangle.v2;
-        unsigned int v3 = triangle.v3;
-        volumeConstraints.gradC.push_back([=](const std::vector<glm::vec3>& x) -> std::vector<glm::vec3> {
-            glm::vec3 n1(0.0f), n2(0.0f), n3(0.0f);
-            n1 += factor * glm::cross(x[v2], x[v3]);
-            n2 += factor * glm::cross(x[v3], x[v1]);
-            n3 += factor * glm::cross(x[v1], x[v2]);
-            return { n1, n2, n3 };
-        });
+        assignVolumeGradient(t);
     }
 }
 
+void Mesh::assignVolumeGradient(size_t t)
+{
+    const Triangle& triangle = volumeConstraints.triangles[t];
+    unsigned int v1 = triangle.v1;
+    unsigned int v2 = triangle.v2;
+    unsigned int v3 = triangle.v3;
+    float factor = 1.0f / 6.0f;
+
+    if (t >= volumeConstraints.gradC.size())
+    {
+        volumeConstraints.gradC.resize(t + 1);
+    }
+
+    volumeConstraints.gradC[t] = [=](const std::vector<glm::vec3>& x) -> std::vector<glm::vec3> {
+        glm::vec3 n1(0.0f), n2(0.0f), n3(0.0f);
+        n1 += factor * glm::cross(x[v2], x[v3]);
+        n2 += factor * glm::cross(x[v3], x[v1]);
+        n3 += factor * glm::cross(x[v1], x[v2]);
+        return { n1, n2, n3 };
+    };
+}
+
 void Mesh::constructEnvCollisionConstraints()
 {
     for (size_t meshIdx = 0; meshIdx < m_candidateObjectMeshes.size(); ++meshIdx)
     {
         const auto& cMesh = m_candidateObjectMeshes[meshIdx];
-        if (!cMesh) continue;
+        if (!cMesh || cMesh->getCollisionPlanes().normals.empty()) continue;
 
-        // Create a new EnvCollisionConstraints for this mesh
+        // the planes live in the candidate mesh; only the vertex list and the
+        // last separating plane per vertex are stored here
         EnvCollisionConstraints envCollisionConstraints;
         envCollisionConstraints.candidateMesh = cMesh;
+        envCollisionConstraints.vertices = envCollisionConstraintVertices;
+        envCollisionConstraints.lastPlanes.assign(envCollisionConstraintVertices.size(), 0);
+
+        if (!envCollisionConstraints.vertices.empty())
+        {
+            perEnvCollisionConstraints.push_back(std::move(envCollisionConstraints));
+        }
+    }
+}
+
+void Mesh::updateCollisionPlanes()
+{
+    // one plane per triangle, through its first corner
+    size_t numPlanes = m_vertices.size() / 3;
+    m_collisionPlanes.normals.resize(numPlanes);
+    m_collisionPlanes.offsets.resize(numPlanes);
+    for (size_t f = 0; f < numPlanes; ++f)
+    {
+        const Vertex& vertex = m_vertices[3 * f];
+        m_collisionPlanes.normals[f] = vertex.normal;
+        m_collisionPlanes.offsets[f] = glm::dot(vertex.normal, vertex.position);
+    }
+}
+
+void Mesh::partitionConstraintGraph(int numParts)
+{
+    MeshPartitioner partitioner(m_positions.size(), distanceConstraints.edges);
+    partition = partitioner.partition(numParts);
+}
+
+float Mesh::calculateStrain(size_t j) const
+{
+    const Edge& edge = distanceConstraints.edges[j];
+    float d_0 = glm::distance(m_restPositions[edge.v1], m_restPositions[edge.v2]);
+    float d = glm::distance(m_positions[edge.v1], m_positions[edge.v2]);
+    return d_0 > 0.0f ? d / d_0 - 1.0f : 0.0f;
+}
+
+float Mesh::calculateMeanRestEdgeLength() const
+{
+    const auto& edges = distanceConstraints.edges;
+    if (edges.empty()) return 0.0f;
+
+    float sum = 0.0f;
+    for (const Edge& edge : edges)
+    {
+        sum += glm::distance(m_restPositions[edge.v1], m_restPositions[edge.v2]);
+    }
+    return sum / edges.size();
+}
+
+bool Mesh::areAdjacent(unsigned int a, unsigned int b) const
+{
+    for (unsigned int j : m_vertexEdges[a])
+    {
+        const Edge& edge = distanceConstraints.edges[j];
+        if (edge.v1 == b || edge.v2 == b) return true;
+    }
+    return false;
+}
+
+int Mesh::splitVertex(unsigned int v, const glm::vec3& planeNormal)
+{
+    // split the triangle fan of v by the plane through v; the positive side
+    // moves to a new vertex w, everything else stays on v
+    const glm::vec3 origin = m_positions[v];
+    std::vector<unsigned int> moved;
+    std::vector<unsigned int> kept;
+    for (unsigned int t : m_vertexTriangles[v])
+    {
+        const Triangle& tri = volumeConstraints.triangles[t];
+        glm::vec3 centroid = (m_positions[tri.v1] + m_positions[tri.v2] + m_positions[tri.v3]) / 3.0f;
+        if (glm::dot(centroid - origin, planeNormal) > 0.0f)
+        {
+            moved.push_back(t);
+        }
+        else
+        {
+            kept.push_back(t);
+        }
+    }
+    if (moved.empty() || kept.empty()) return -1;
+
+    const unsigned int w = static_cast<unsigned int>(m_positions.size());
+    m_positions.push_back(origin);
+    m_restPositions.push_back(m_restPositions[v]);
+
+    // the tables are patched row by row and compacted once per frame
+    m_duplicatePositionIndices.appendRow();
+    m_vertexTriangles.appendRow();
+    m_vertexEdges.appendRow();
+    m_vertexStencils.appendRow();
+    for (unsigned int t : moved)
+    {
+        m_vertexTriangles.erase(v, t);
+        m_vertexTriangles.insert(w, t);
+    }
 
-        // Get vertices from the candidate mesh
-        const auto& vertices = cMesh->getVertices();
+    auto containsVertex = [](const Triangle& tri, unsigned int u) {
+        return tri.v1 == u || tri.v2 == u || tri.v3 == u;
+    };
+    auto fanContains = [&](const std::vector<unsigned int>& fan, unsigned int a, unsigned int b) {
+        for (unsigned int t : fan)
+        {
+            const Triangle& tri = volumeConstraints.triangles[t];
+            if (containsVertex(tri, a) && containsVertex(tri, b)) return true;
+        }
+        return false;
+    };
+
+    // render vertices still used by the kept side must be duplicated,
+    // the others simply change owner
+    std::set<unsigned int> keptCorners;
+    for (unsigned int t : kept)
+    {
+        const Triangle& tri = volumeConstraints.triangles[t];
+        const unsigned int corners[3] = { tri.v1, tri.v2, tri.v3 };
+        for (size_t k = 0; k < 3; ++k)
+        {
+            if (corners[k] == v) keptCorners.insert(m_indices[3 * t + k]);
+        }
+    }
 
-        // Loop through source vertices
-        for (const auto& v : envCollisionConstraintVertices)
+    std::map<unsigned int, unsigned int> duplicatedCorners;
+    for (unsigned int t : moved)
+    {
+        Triangle& tri = volumeConstraints.triangles[t];
+        unsigned int* corners[3] = { &tri.v1, &tri.v2, &tri.v3 };
+        for (size_t k = 0; k < 3; ++k)
         {
-            // Only process every third vertex (first vertex of each triangle)
-            for (size_t vIdx = 0; vIdx < vertices.size(); vIdx += 3)
+            if (*corners[k] != v) continue;
+            *corners[k] = w;
+
+            unsigned int& r = m_indices[3 * t + k];
+            if (!keptCorners.count(r))
+            {
+                if (m_vertexPositionIndices[r] == v)
+                {
+                    m_vertexPositionIndices[r] = w;
+                    m_duplicatePositionIndices.erase(v, r);
+                    m_duplicatePositionIndices.insert(w, r);
+                }
+                continue;
+            }
+
+            auto it = duplicatedCorners.find(r);
+            if (it == duplicatedCorners.end())
             {
-                // Store the index where this constraint will be added
-                size_t constraintIdx = envCollisionConstraints.C.size();
-
-                // Add to map of vertex to constraint indices
-                envCollisionConstraints.vertexToConstraints[v].push_back(constraintIdx);
-
-                // Create constraint function
-                envCollisionConstraints.C.push_back(
-                    [v, vIdx, cMesh=cMesh](const std::vector<glm::vec3>& x) -> float {
-                        const auto& cVertex = cMesh->getVertices()[vIdx];
-                        float dot = glm::dot(cVertex.normal, x[v] - cVertex.position);
-                        return dot;
-                    });
-
-                // Create gradient function
-                envCollisionConstraints.gradC.push_back(
-                    [v, vIdx, cMesh=cMesh](const std::vector<glm::vec3>& x) -> std::vector<glm::vec3> {
-                        const auto& cVertex = cMesh->getVertices()[vIdx];
-                        return { cVertex.normal };
-                    });
-
-                // Store affected vertex
-                envCollisionConstraints.vertices.push_back(v);
+                unsigned int copy = static_cast<unsigned int>(m_vertices.size());
+                m_vertices.push_back(m_vertices[r]);
+                m_vertexPositionIndices.push_back(w);
+                m_duplicatePositionIndices.insert(w, copy);
+                it = duplicatedCorners.emplace(r, copy).first;
             }
+            r = it->second;
         }
+        assignVolumeGradient(t);
+    }
+
+    // edges of moved triangles follow them; edges on the crack are needed by both sides
+    std::span<const unsigned int> edgeRow = m_vertexEdges[v];
+    std::vector<unsigned int> vertexEdges(edgeRow.begin(), edgeRow.end());
+    for (unsigned int j : vertexEdges)
+    {
+        Edge edge = distanceConstraints.edges[j];
+        unsigned int u = edge.v1 == v ? edge.v2 : edge.v1;
+        bool onMovedSide = fanContains(moved, w, u);
+        bool onKeptSide = fanContains(kept, v, u);
 
-        // Only add if we have constraints
-        if (!envCollisionConstraints.C.empty())
+        if (onMovedSide && !onKeptSide)
+        {
+            (edge.v1 == v ? distanceConstraints.edges[j].v1 : distanceConstraints.edges[j].v2) = w;
+            assignDistanceConstraint(j);
+            m_vertexEdges.erase(v, j);
+            m_vertexEdges.insert(w, j);
+        }
+        else if (onMovedSide && onKeptSide)
         {
-            perEnvCollisionConstraints.push_back(envCollisionConstraints);
+            unsigned int k = static_cast<unsigned int>(distanceConstraints.edges.size());
+            distanceConstraints.edges.push_back({ w, u });
+            assignDistanceConstraint(k);
+            m_vertexEdges.insert(w, k);
+            m_vertexEdges.insert(u, k);
+
+            if (!partition.empty())
+            {
+                int part = partition.vertexPart[v];
+                if (partition.vertexPart[u] == part)
+                {
+                    partition.interiorConstraints[part].push_back(k);
+                }
+                else
+                {
+                    partition.boundaryConstraints.push_back(k);
+                    partition.edgeCut++;
+                }
+            }
         }
     }
+
+    // stencils whose two triangles end up on different sides are no longer
+    // hinged, the others follow their triangles
+    std::vector<unsigned int> brokenStencils;
+    std::span<const unsigned int> stencilRow = m_vertexStencils[v];
+    std::vector<unsigned int> vertexStencils(stencilRow.begin(), stencilRow.end());
+    for (unsigned int j : vertexStencils)
+    {
+        BendingStencil& stencil = bendingConstraints.stencils[j];
+        bool changed = false;
+        if (stencil.v1 == v || stencil.v2 == v)
+        {
+            unsigned int u = stencil.v1 == v ? stencil.v2 : stencil.v1;
+            bool firstMoved = fanContains(moved, u, stencil.v3);
+            bool secondMoved = fanContains(moved, u, stencil.v4);
+            if (firstMoved != secondMoved)
+            {
+                brokenStencils.push_back(j);
+                continue;
+            }
+            if (firstMoved)
+            {
+                (stencil.v1 == v ? stencil.v1 : stencil.v2) = w;
+                changed = true;
+            }
+        }
+        else if (stencil.v3 == v && fanContains(moved, stencil.v1, stencil.v2))
+        {
+            stencil.v3 = w;
+            changed = true;
+        }
+        else if (stencil.v4 == v && fanContains(moved, stencil.v1, stencil.v2))
+        {
+            stencil.v4 = w;
+            changed = true;
+        }
+
+        if (changed)
+        {
+            assignBendingConstraint(j);
+            m_vertexStencils.erase(v, j);
+            m_vertexStencils.insert(w, j);
+        }
+    }
+
+    // highest index first so swap-and-pop never moves a stencil still to be removed
+    std::sort(brokenStencils.rbegin(), brokenStencils.rend());
+    for (unsigned int j : brokenStencils)
+    {
+        removeBendingConstraint(j);
+    }
+
+    // the new particle belongs to the domain of the one it split from
+    if (!partition.empty())
+    {
+        int part = partition.vertexPart[v];
+        partition.vertexPart.push_back(part);
+        partition.partSizes[part]++;
+    }
+
+    envCollisionConstraintVertices.push_back(w);
+    for (auto& envCollisionConstraints : perEnvCollisionConstraints)
+    {
+        envCollisionConstraints.vertices.push_back(w);
+        envCollisionConstraints.lastPlanes.push_back(0);
+    }
+
+    m_buffersDirty = true;
+    return static_cast<int>(w);
+}
+
+void Mesh::compactAdjacency()
+{
+    // splits leave their rows in overflow lists until the end of the frame
+    m_duplicatePositionIndices.compact();
+    m_vertexTriangles.compact();
+    m_vertexEdges.compact();
+    m_vertexStencils.compact();
+}
+
+void Mesh::restoreTopology(const Mesh& pristine)
+{
+    // buffers created for the torn mesh are not shared with anyone
+    if (m_ownsBuffers)
+    {
+        destroy();
+    }
+    *this = pristine;
 }
 
 void Mesh::initVerticesBuffer()
@@ -398,13 +1120,14 @@ void Mesh::initNormalBuffers(GLuint& vao, GLuint& vbo, size_t numElements)
     glBindVertexArray(0);
 }
 
-Mesh::Mesh(const std::string& name, const std::string& meshPath)
+Mesh::Mesh(const std::string& name, const std::string& meshPath, float weldEpsilon)
     : m_name(name),
       m_meshPath(meshPath),
       m_vertexNormalLength(0.1f),
       m_faceNormalLength(0.5f)
 {
-    loadObjData(meshPath);
+    loadObjData(meshPath, weldEpsilon);
+    updateCollisionPlanes();
     initVerticesBuffer();
     initNormalBuffers(m_vertexNormalVAO, m_vertexNormalVBO, m_vertices.size());
     initNormalBuffers(m_faceNormalVAO, m_faceNormalVBO, m_indices.size() / 3);
@@ -442,10 +1165,26 @@ void Mesh::update()
         m_vertices[idx1].normal = faceNormal;
         m_vertices[idx2].normal = faceNormal;
     }
+
+    updateCollisionPlanes();
 }
 
 void Mesh::draw()
 {
+    // a torn mesh no longer fits the buffers it shared with its source mesh
+    if (m_buffersDirty)
+    {
+        if (m_ownsBuffers)
+        {
+            destroy();
+        }
+        initVerticesBuffer();
+        initNormalBuffers(m_vertexNormalVAO, m_vertexNormalVBO, m_vertices.size());
+        initNormalBuffers(m_faceNormalVAO, m_faceNormalVBO, m_indices.size() / 3);
+        m_ownsBuffers = true;
+        m_buffersDirty = false;
+    }
+
     glBindVertexArray(m_VAO);
     glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
     glBufferSubData(GL_ARRAY_BUFFER, 0, m_vertices.size() * sizeof(Vertex), &m_vertices[0]);
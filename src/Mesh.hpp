@@ -2,6 +2,8 @@
 
 #include <string>
 #include <vector>
+#include <array>
+#include <algorithm>
 #include <functional>
 #include <fstream>
 #include <sstream>
@@ -13,10 +15,15 @@
 #include <assimp/postprocess.h>
 #include <set>
 #include <map>
+#include <unordered_map>
+#include <cstring>
+#include <cstdint>
 
 
 #include "Transform.hpp"
 #include "Shader.hpp"
+#include "MeshPartitioner.hpp"
+#include "Adjacency.hpp"
 
 
 class Object; // Forward declaration
@@ -42,14 +49,26 @@ struct Triangle
     unsigned int v3;
 };
 
+// Two triangles sharing the edge (v1, v2), with opposite vertices v3 and v4
+struct BendingStencil
+{
+    unsigned int v1;
+    unsigned int v2;
+    unsigned int v3;
+    unsigned int v4;
+};
+
 
 class Mesh
 {
 public:
     Mesh() = default;
+    // vertices closer than weldEpsilon share one position; 0 welds only
+    // exactly equal positions
     Mesh(
         const std::string& name,
-        const std::string& meshPath
+        const std::string& meshPath,
+        float weldEpsilon = 0.0f
     );
 
     const std::string getName()     const { return m_name; }
@@ -64,11 +83,23 @@ public:
     void setCandidateObjectMeshes(const std::vector<Object*>& objects);
 
     void constructDistanceConstraints();
+    void constructBendingConstraints();
     void constructVolumeConstraints(float& k);
     void constructEnvCollisionConstraints();
+    void partitionConstraintGraph(int numParts);
+
+    float calculateStrain(size_t j) const;
+    float calculateMeanRestEdgeLength() const;
+    bool areAdjacent(unsigned int a, unsigned int b) const;
+    size_t getNumAdjacentTriangles(unsigned int v) const { return m_vertexTriangles[v].size(); }
+    int splitVertex(unsigned int v, const glm::vec3& planeNormal);
+    void compactAdjacency();
+    void restoreTopology(const Mesh& pristine);
 
 public:
     std::vector<glm::vec3>& getPositions() { return m_positions; }
+    const std::vector<glm::vec3>& getRestPositions() const { return m_restPositions; }
+    size_t getNumPositions() const { return m_positions.size(); }
     const std::vector<Vertex>& getVertices() const { return m_vertices; }
 
     struct DistanceConstraints
@@ -79,6 +110,24 @@ public:
     };
     DistanceConstraints distanceConstraints;
 
+    struct BendingConstraints
+    {
+        std::vector<BendingStencil> stencils;
+        std::vector<std::function<float(const std::vector<glm::vec3>&)>> C;
+        std::vector<std::function<std::vector<glm::vec3>(const std::vector<glm::vec3>&)>> gradC;
+    };
+    BendingConstraints bendingConstraints;
+
+    static std::array<float, 16> calculateBendingMatrix(
+        const BendingStencil& stencil,
+        const std::vector<glm::vec3>& x
+    );
+    static float calculateBendingEnergy(
+        const BendingStencil& stencil,
+        const std::array<float, 16>& Q,
+        const std::vector<glm::vec3>& x
+    );
+
     struct VolumeConstraints
     {
         std::vector<Triangle> triangles;
@@ -87,43 +136,77 @@ public:
     };
     VolumeConstraints volumeConstraints;
 
+    MeshPartition partition;
+
+    // face planes n . x = d of this mesh as a collision candidate, in the
+    // space of its vertices; shared by every soft body tested against it
+    struct CollisionPlanes
+    {
+        std::vector<glm::vec3> normals;
+        std::vector<float> offsets;
+    };
+    const CollisionPlanes& getCollisionPlanes() const { return m_collisionPlanes; }
+
+    // a vertex collides when it is behind every plane of the candidate; the
+    // plane it was last found in front of is tested first
     std::vector<unsigned int> envCollisionConstraintVertices;
     struct EnvCollisionConstraints
     {
-        std::vector<unsigned int> vertices;
         const Mesh* candidateMesh;
-        std::vector<std::function<float(const std::vector<glm::vec3>&)>> C;
-        std::vector<std::function<std::vector<glm::vec3>(const std::vector<glm::vec3>&)>> gradC;
-        std::map<unsigned int, std::vector<size_t>> vertexToConstraints;
+        std::vector<unsigned int> vertices;
+        std::vector<unsigned int> lastPlanes;
     };
     std::vector<EnvCollisionConstraints> perEnvCollisionConstraints;
 
 private:
-    void loadObjData(const std::string& meshPath);
+    void loadObjData(const std::string& meshPath, float weldEpsilon);
+
+    // everything loadObjData derives from the file, cached in binary under a
+    // key from the file's content, the weld epsilon and the cache version
+    static uint64_t calculateCacheKey(const std::string& meshPath, float weldEpsilon);
+    bool saveCache(const std::string& path, uint64_t key) const;
+    bool loadCache(const std::string& path, uint64_t key);
 
     void initVerticesBuffer();
     void initNormalBuffers(GLuint& vao, GLuint& vbo, size_t numElements);
 
     void constructVertices(const aiMesh* mesh);
+    void weldPositions(float epsilon);
     void constructIndices(const aiMesh* mesh);
 
     std::vector<Triangle> constructTriangles();
     std::vector<glm::vec3> calculateFaceNormals();
+    void updateCollisionPlanes();
 
     void constructDistanceConstraintVertices();
     void constructVolumeConstraintVertices();
     void constructEnvCollisionConstraintVertices();
+    void constructAdjacency();
+
+    void assignDistanceConstraint(size_t j);
+    void assignBendingConstraint(size_t j);
+    void assignVolumeGradient(size_t t);
+    void removeBendingConstraint(size_t j);
 
 private:
     std::string m_name;
     std::string m_meshPath;
 
     std::vector<glm::vec3> m_positions;
-    std::vector<std::vector<unsigned int>> m_duplicatePositionIndices;
+    std::vector<glm::vec3> m_restPositions;
+    std::vector<unsigned int> m_vertexPositionIndices;   // render vertex to position
+    Adjacency m_duplicatePositionIndices;                // position to render vertices
+
+    // per position: incident triangles, distance constraints and bending stencils
+    Adjacency m_vertexTriangles;
+    Adjacency m_vertexEdges;
+    Adjacency m_vertexStencils;
 
     GLuint m_VAO, m_VBO, m_EBO;
     std::vector<Vertex> m_vertices;
     std::vector<unsigned int> m_indices;
+    bool m_buffersDirty = false;
+    bool m_ownsBuffers = false;
 
     GLuint m_vertexNormalVAO, m_vertexNormalVBO;
     GLuint m_faceNormalVAO, m_faceNormalVBO;
@@ -131,4 +214,5 @@ private:
     float m_faceNormalLength;
 
     std::vector<const Mesh*> m_candidateObjectMeshes;
+    CollisionPlanes m_collisionPlanes;
 };
\ No newline at end of file
@@ -0,0 +1,563 @@
+#include "MeshPartitioner.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <numeric>
+#include <queue>
+
+#include "Mesh.hpp"
+
+void MeshPartition::print(const std::string& name) const
+{
+    std::cout << name << " partitioned into " << numParts << " domains: "
+              << "edge cut = " << edgeCut << ", "
+              << "boundary vertices = " << boundaryVertices << ", "
+              << "load imbalance = " << loadImbalance << ", "
+              << "disconnected domains = " << disconnectedParts << '\n';
+}
+
+MeshPartitioner::MeshPartitioner(size_t numVertices, const std::vector<Edge>& edges)
+    : m_edges(edges)
+{
+    // CSR adjacency with unit vertex and edge weights
+    std::vector<unsigned int> degree(numVertices, 0);
+    for (const auto& e : edges)
+    {
+        degree[e.v1]++;
+        degree[e.v2]++;
+    }
+
+    m_graph.xadj.assign(numVertices + 1, 0);
+    for (size_t v = 0; v < numVertices; ++v)
+    {
+        m_graph.xadj[v + 1] = m_graph.xadj[v] + degree[v];
+    }
+
+    m_graph.adjncy.resize(m_graph.xadj.back());
+    m_graph.adjwgt.assign(m_graph.xadj.back(), 1);
+    m_graph.vwgt.assign(numVertices, 1);
+
+    std::vector<unsigned int> cursor(m_graph.xadj.begin(), m_graph.xadj.end() - 1);
+    for (const auto& e : edges)
+    {
+        m_graph.adjncy[cursor[e.v1]++] = e.v2;
+        m_graph.adjncy[cursor[e.v2]++] = e.v1;
+    }
+}
+
+MeshPartitioner::Graph MeshPartitioner::coarsen(const Graph& graph, std::vector<unsigned int>& fineToCoarse)
+{
+    const size_t n = graph.numVertices();
+    const unsigned int unmatched = static_cast<unsigned int>(-1);
+
+    // heavy-edge matching, lightest vertices first to keep coarse weights even
+    std::vector<unsigned int> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](unsigned int a, unsigned int b) {
+        return graph.vwgt[a] < graph.vwgt[b];
+    });
+
+    std::vector<unsigned int> match(n, unmatched);
+    for (unsigned int v : order)
+    {
+        if (match[v] != unmatched) continue;
+
+        unsigned int best = v;
+        unsigned int bestWeight = 0;
+        for (unsigned int k = graph.xadj[v]; k < graph.xadj[v + 1]; ++k)
+        {
+            unsigned int u = graph.adjncy[k];
+            if (match[u] == unmatched && u != v && graph.adjwgt[k] > bestWeight)
+            {
+                best = u;
+                bestWeight = graph.adjwgt[k];
+            }
+        }
+        match[v] = best;
+        match[best] = v;
+    }
+
+    // number coarse vertices
+    fineToCoarse.assign(n, unmatched);
+    unsigned int numCoarse = 0;
+    for (unsigned int v = 0; v < n; ++v)
+    {
+        if (fineToCoarse[v] != unmatched) continue;
+        fineToCoarse[v] = numCoarse;
+        fineToCoarse[match[v]] = numCoarse;
+        numCoarse++;
+    }
+
+    // collapse edges, summing weights of parallel edges
+    Graph coarse;
+    coarse.vwgt.assign(numCoarse, 0);
+    coarse.xadj.assign(numCoarse + 1, 0);
+    for (unsigned int v = 0; v < n; ++v)
+    {
+        coarse.vwgt[fineToCoarse[v]] += graph.vwgt[v];
+    }
+
+    std::vector<std::vector<unsigned int>> members(numCoarse);
+    for (unsigned int v = 0; v < n; ++v)
+    {
+        members[fineToCoarse[v]].push_back(v);
+    }
+
+    std::vector<int> slot(numCoarse, -1);
+    for (unsigned int c = 0; c < numCoarse; ++c)
+    {
+        size_t begin = coarse.adjncy.size();
+        for (unsigned int v : members[c])
+        {
+            for (unsigned int k = graph.xadj[v]; k < graph.xadj[v + 1]; ++k)
+            {
+                unsigned int cu = fineToCoarse[graph.adjncy[k]];
+                if (cu == c) continue;
+
+                if (slot[cu] < 0)
+                {
+                    slot[cu] = static_cast<int>(coarse.adjncy.size());
+                    coarse.adjncy.push_back(cu);
+                    coarse.adjwgt.push_back(0);
+                }
+                coarse.adjwgt[slot[cu]] += graph.adjwgt[k];
+            }
+        }
+
+        for (size_t k = begin; k < coarse.adjncy.size(); ++k)
+        {
+            slot[coarse.adjncy[k]] = -1;
+        }
+        coarse.xadj[c + 1] = static_cast<unsigned int>(coarse.adjncy.size());
+    }
+
+    return coarse;
+}
+
+unsigned int MeshPartitioner::findPeripheralVertex(
+    const Graph& graph,
+    const std::vector<unsigned int>& vertices,
+    const std::vector<int>& inSubset
+)
+{
+    // two BFS sweeps: the vertex farthest from the farthest vertex
+    std::vector<int> depth(graph.numVertices(), -1);
+    unsigned int last = vertices.front();
+    for (int sweep = 0; sweep < 2; ++sweep)
+    {
+        for (unsigned int v : vertices) depth[v] = -1;
+
+        std::queue<unsigned int> queue;
+        queue.push(last);
+        depth[last] = 0;
+        while (!queue.empty())
+        {
+            unsigned int v = queue.front();
+            queue.pop();
+            last = v;
+            for (unsigned int k = graph.xadj[v]; k < graph.xadj[v + 1]; ++k)
+            {
+                unsigned int u = graph.adjncy[k];
+                if (inSubset[u] && depth[u] < 0)
+                {
+                    depth[u] = depth[v] + 1;
+                    queue.push(u);
+                }
+            }
+        }
+    }
+    return last;
+}
+
+void MeshPartitioner::bisect(
+    const Graph& graph,
+    const std::vector<unsigned int>& vertices,
+    int firstPart,
+    int numParts,
+    std::vector<int>& part
+)
+{
+    if (numParts == 1 || vertices.empty())
+    {
+        for (unsigned int v : vertices) part[v] = firstPart;
+        return;
+    }
+
+    const int leftParts = numParts / 2;
+    unsigned int totalWeight = 0;
+    std::vector<int> inSubset(graph.numVertices(), 0);
+    for (unsigned int v : vertices)
+    {
+        inSubset[v] = 1;
+        totalWeight += graph.vwgt[v];
+    }
+    const unsigned int target = static_cast<unsigned int>(
+        static_cast<unsigned long long>(totalWeight) * leftParts / numParts
+    );
+
+    // grow the left side from a peripheral vertex, always taking the frontier
+    // vertex most connected to the region; restart on disconnected pieces
+    std::vector<unsigned int> gain(graph.numVertices(), 0);
+    std::vector<int> taken(graph.numVertices(), 0);
+    using Entry = std::pair<unsigned int, unsigned int>;
+    std::priority_queue<Entry> frontier;
+    frontier.push({ 0, findPeripheralVertex(graph, vertices, inSubset) });
+
+    unsigned int weight = 0;
+    size_t nextSeed = 0;
+    while (weight < target)
+    {
+        if (frontier.empty())
+        {
+            while (nextSeed < vertices.size() && taken[vertices[nextSeed]]) nextSeed++;
+            if (nextSeed == vertices.size()) break;
+            frontier.push({ gain[vertices[nextSeed]], vertices[nextSeed] });
+        }
+
+        auto [g, v] = frontier.top();
+        frontier.pop();
+        if (taken[v] || g != gain[v]) continue;
+
+        taken[v] = 1;
+        weight += graph.vwgt[v];
+        for (unsigned int k = graph.xadj[v]; k < graph.xadj[v + 1]; ++k)
+        {
+            unsigned int u = graph.adjncy[k];
+            if (!inSubset[u] || taken[u]) continue;
+            gain[u] += graph.adjwgt[k];
+            frontier.push({ gain[u], u });
+        }
+    }
+
+    std::vector<unsigned int> left, right;
+    for (unsigned int v : vertices)
+    {
+        (taken[v] ? left : right).push_back(v);
+    }
+
+    bisect(graph, left, firstPart, leftParts, part);
+    bisect(graph, right, firstPart + leftParts, numParts - leftParts, part);
+}
+
+std::vector<int> MeshPartitioner::growInitialPartition(const Graph& graph, int numParts)
+{
+    std::vector<int> part(graph.numVertices(), 0);
+    std::vector<unsigned int> vertices(graph.numVertices());
+    std::iota(vertices.begin(), vertices.end(), 0);
+
+    bisect(graph, vertices, 0, numParts, part);
+    return part;
+}
+
+bool MeshPartitioner::keepsDomainConnected(
+    const Graph& graph,
+    const std::vector<int>& part,
+    unsigned int v,
+    std::vector<unsigned int>& visited,
+    unsigned int& stamp
+)
+{
+    // v may leave its domain if its same-domain neighbours can still reach each
+    // other through that domain within a few hops, without passing through v
+    const int from = part[v];
+    const int maxDepth = 3;
+
+    unsigned int first = v;
+    size_t numNeighbours = 0;
+    for (unsigned int k = graph.xadj[v]; k < graph.xadj[v + 1]; ++k)
+    {
+        unsigned int u = graph.adjncy[k];
+        if (part[u] != from) continue;
+        if (numNeighbours++ == 0) first = u;
+    }
+    if (numNeighbours <= 1) return true;
+
+    stamp++;
+    visited[v] = stamp;
+    visited[first] = stamp;
+    std::vector<unsigned int> layer = { first };
+    for (int depth = 0; depth < maxDepth && !layer.empty(); ++depth)
+    {
+        std::vector<unsigned int> next;
+        for (unsigned int w : layer)
+        {
+            for (unsigned int k = graph.xadj[w]; k < graph.xadj[w + 1]; ++k)
+            {
+                unsigned int u = graph.adjncy[k];
+                if (part[u] != from || visited[u] == stamp) continue;
+                visited[u] = stamp;
+                next.push_back(u);
+            }
+        }
+        layer = std::move(next);
+    }
+
+    for (unsigned int k = graph.xadj[v]; k < graph.xadj[v + 1]; ++k)
+    {
+        unsigned int u = graph.adjncy[k];
+        if (part[u] == from && visited[u] != stamp) return false;
+    }
+    return true;
+}
+
+void MeshPartitioner::refine(const Graph& graph, std::vector<int>& part, int numParts, float maxImbalance)
+{
+    const size_t n = graph.numVertices();
+    unsigned int totalWeight = std::accumulate(graph.vwgt.begin(), graph.vwgt.end(), 0u);
+    float maxWeight = maxImbalance * static_cast<float>(totalWeight) / static_cast<float>(numParts);
+
+    std::vector<unsigned int> partWeight(numParts, 0);
+    for (size_t v = 0; v < n; ++v)
+    {
+        partWeight[part[v]] += graph.vwgt[v];
+    }
+
+    std::vector<unsigned int> connectivity(numParts, 0);
+    std::vector<unsigned int> visited(n, 0);
+    unsigned int stamp = 0;
+    const int maxPasses = 32;
+    for (int pass = 0; pass < maxPasses; ++pass)
+    {
+        size_t moves = 0;
+        for (unsigned int v = 0; v < n; ++v)
+        {
+            int from = part[v];
+            bool isBoundary = false;
+            for (unsigned int k = graph.xadj[v]; k < graph.xadj[v + 1]; ++k)
+            {
+                connectivity[part[graph.adjncy[k]]] += graph.adjwgt[k];
+                isBoundary |= part[graph.adjncy[k]] != from;
+            }
+
+            if (isBoundary)
+            {
+                // best positive-gain move that respects the balance bound; zero-gain
+                // moves only when they improve balance, any move out of an
+                // overweight domain when it makes things less uneven
+                int best = from;
+                int bestGain = 0;
+                for (unsigned int k = graph.xadj[v]; k < graph.xadj[v + 1]; ++k)
+                {
+                    int to = part[graph.adjncy[k]];
+                    if (to == from || to == best) continue;
+
+                    int g = static_cast<int>(connectivity[to]) - static_cast<int>(connectivity[from]);
+                    unsigned int newWeight = partWeight[to] + graph.vwgt[v];
+                    bool balances = newWeight < partWeight[from];
+                    bool allowed = (newWeight <= maxWeight && (g > 0 || (g == 0 && balances))) ||
+                                   (partWeight[from] > maxWeight && balances);
+                    if (!allowed) continue;
+
+                    if (best == from || g > bestGain || (g == bestGain && partWeight[to] < partWeight[best]))
+                    {
+                        best = to;
+                        bestGain = g;
+                    }
+                }
+
+                if (best != from && partWeight[from] > graph.vwgt[v] &&
+                    keepsDomainConnected(graph, part, v, visited, stamp))
+                {
+                    part[v] = best;
+                    partWeight[from] -= graph.vwgt[v];
+                    partWeight[best] += graph.vwgt[v];
+                    moves++;
+                }
+            }
+
+            for (unsigned int k = graph.xadj[v]; k < graph.xadj[v + 1]; ++k)
+            {
+                connectivity[part[graph.adjncy[k]]] = 0;
+            }
+            connectivity[from] = 0;
+        }
+
+        if (moves == 0) break;
+    }
+}
+
+void MeshPartitioner::mergeDisconnectedFragments(const Graph& graph, std::vector<int>& part, int numParts)
+{
+    const size_t n = graph.numVertices();
+    std::vector<int> component(n, -1);
+    std::vector<unsigned int> componentSize;
+    std::vector<int> componentPart;
+
+    // label connected components within each domain
+    for (unsigned int s = 0; s < n; ++s)
+    {
+        if (component[s] >= 0) continue;
+
+        int c = static_cast<int>(componentSize.size());
+        componentSize.push_back(0);
+        componentPart.push_back(part[s]);
+
+        std::vector<unsigned int> stack = { s };
+        component[s] = c;
+        while (!stack.empty())
+        {
+            unsigned int v = stack.back();
+            stack.pop_back();
+            componentSize[c] += graph.vwgt[v];
+            for (unsigned int k = graph.xadj[v]; k < graph.xadj[v + 1]; ++k)
+            {
+                unsigned int u = graph.adjncy[k];
+                if (component[u] < 0 && part[u] == part[s])
+                {
+                    component[u] = c;
+                    stack.push_back(u);
+                }
+            }
+        }
+    }
+
+    // keep the largest component of every domain
+    std::vector<int> largest(numParts, -1);
+    for (int c = 0; c < static_cast<int>(componentSize.size()); ++c)
+    {
+        int p = componentPart[c];
+        if (largest[p] < 0 || componentSize[c] > componentSize[largest[p]]) largest[p] = c;
+    }
+
+    // hand every other fragment to the domain it shares the most edges with
+    std::vector<int> fragment(componentSize.size(), -1);
+    int numFragments = 0;
+    for (int c = 0; c < static_cast<int>(componentSize.size()); ++c)
+    {
+        if (largest[componentPart[c]] != c) fragment[c] = numFragments++;
+    }
+    if (numFragments == 0) return;
+
+    std::vector<unsigned int> shared(static_cast<size_t>(numFragments) * numParts, 0);
+    for (unsigned int v = 0; v < n; ++v)
+    {
+        int f = fragment[component[v]];
+        if (f < 0) continue;
+        for (unsigned int k = graph.xadj[v]; k < graph.xadj[v + 1]; ++k)
+        {
+            unsigned int u = graph.adjncy[k];
+            if (component[u] != component[v]) shared[f * numParts + part[u]] += graph.adjwgt[k];
+        }
+    }
+
+    std::vector<int> target(numFragments, -1);
+    for (int f = 0; f < numFragments; ++f)
+    {
+        auto begin = shared.begin() + f * numParts;
+        auto best = std::max_element(begin, begin + numParts);
+        if (*best > 0) target[f] = static_cast<int>(best - begin);
+    }
+
+    for (unsigned int v = 0; v < n; ++v)
+    {
+        int f = fragment[component[v]];
+        if (f >= 0 && target[f] >= 0) part[v] = target[f];
+    }
+}
+
+MeshPartition MeshPartitioner::partition(int numParts, float maxImbalance) const
+{
+    MeshPartition result;
+    const size_t n = m_graph.numVertices();
+    if (numParts < 2 || n < static_cast<size_t>(numParts)) return result;
+
+    // coarsen until the graph is small or matching stops paying off
+    std::vector<Graph> levels = { m_graph };
+    std::vector<std::vector<unsigned int>> maps;
+    const size_t coarsestSize = std::max<size_t>(20 * numParts, 100);
+    while (levels.back().numVertices() > coarsestSize)
+    {
+        std::vector<unsigned int> fineToCoarse;
+        Graph coarse = coarsen(levels.back(), fineToCoarse);
+        if (coarse.numVertices() > 0.9 * levels.back().numVertices()) break;
+
+        levels.push_back(std::move(coarse));
+        maps.push_back(std::move(fineToCoarse));
+    }
+
+    // partition the coarsest graph and project back, refining on every level;
+    // fragments are reattached per level so finer levels can rebalance them
+    std::vector<int> part = growInitialPartition(levels.back(), numParts);
+    refine(levels.back(), part, numParts, maxImbalance);
+    mergeDisconnectedFragments(levels.back(), part, numParts);
+    for (size_t level = maps.size(); level-- > 0;)
+    {
+        std::vector<int> finePart(levels[level].numVertices());
+        for (size_t v = 0; v < finePart.size(); ++v)
+        {
+            finePart[v] = part[maps[level][v]];
+        }
+        part = std::move(finePart);
+        refine(levels[level], part, numParts, maxImbalance);
+        mergeDisconnectedFragments(levels[level], part, numParts);
+    }
+    refine(m_graph, part, numParts, maxImbalance);
+
+    // classify constraints
+    result.numParts = numParts;
+    result.vertexPart = std::move(part);
+    result.interiorConstraints.assign(numParts, {});
+    result.partSizes.assign(numParts, 0);
+    for (unsigned int j = 0; j < m_edges.size(); ++j)
+    {
+        int p1 = result.vertexPart[m_edges[j].v1];
+        int p2 = result.vertexPart[m_edges[j].v2];
+        if (p1 == p2)
+        {
+            result.interiorConstraints[p1].push_back(j);
+        }
+        else
+        {
+            result.boundaryConstraints.push_back(j);
+        }
+    }
+
+    // metrics
+    result.edgeCut = result.boundaryConstraints.size();
+    for (unsigned int v = 0; v < n; ++v)
+    {
+        int p = result.vertexPart[v];
+        result.partSizes[p]++;
+        for (unsigned int k = m_graph.xadj[v]; k < m_graph.xadj[v + 1]; ++k)
+        {
+            if (result.vertexPart[m_graph.adjncy[k]] != p)
+            {
+                result.boundaryVertices++;
+                break;
+            }
+        }
+    }
+
+    size_t largestPart = *std::max_element(result.partSizes.begin(), result.partSizes.end());
+    result.loadImbalance = static_cast<float>(largestPart) * numParts / static_cast<float>(n);
+
+    std::vector<int> seen(n, 0);
+    for (int p = 0; p < numParts; ++p)
+    {
+        auto it = std::find(result.vertexPart.begin(), result.vertexPart.end(), p);
+        if (it == result.vertexPart.end()) continue;
+
+        unsigned int s = static_cast<unsigned int>(it - result.vertexPart.begin());
+        std::vector<unsigned int> stack = { s };
+        seen[s] = 1;
+        size_t reached = 0;
+        while (!stack.empty())
+        {
+            unsigned int v = stack.back();
+            stack.pop_back();
+            reached++;
+            for (unsigned int k = m_graph.xadj[v]; k < m_graph.xadj[v + 1]; ++k)
+            {
+                unsigned int u = m_graph.adjncy[k];
+                if (!seen[u] && result.vertexPart[u] == p)
+                {
+                    seen[u] = 1;
+                    stack.push_back(u);
+                }
+            }
+        }
+        if (reached != result.partSizes[p]) result.disconnectedParts++;
+    }
+
+    return result;
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+struct Edge;
+
+// Result of splitting a mesh's particle graph into per-thread domains.
+struct MeshPartition
+{
+    int numParts = 0;
+    std::vector<int> vertexPart;
+
+    // distance constraint indices whose vertices all lie in one part
+    std::vector<std::vector<unsigned int>> interiorConstraints;
+    // distance constraint indices that cross a part boundary
+    std::vector<unsigned int> boundaryConstraints;
+
+    // quality metrics
+    std::vector<size_t> partSizes;
+    size_t edgeCut = 0;
+    size_t boundaryVertices = 0;
+    size_t disconnectedParts = 0;
+    float loadImbalance = 0.0f;
+
+    bool empty() const { return numParts < 2; }
+    void print(const std::string& name) const;
+};
+
+// Multilevel k-way partitioner in the style of METIS: heavy-edge matching
+// coarsening, recursive greedy graph-growing bisection of the coarsest graph and boundary
+// refinement while projecting back to the original graph.
+class MeshPartitioner
+{
+public:
+    MeshPartitioner(size_t numVertices, const std::vector<Edge>& edges);
+
+    MeshPartition partition(int numParts, float maxImbalance = 1.03f) const;
+
+private:
+    struct Graph
+    {
+        std::vector<unsigned int> xadj;
+        std::vector<unsigned int> adjncy;
+        std::vector<unsigned int> adjwgt;
+        std::vector<unsigned int> vwgt;
+
+        size_t numVertices() const { return vwgt.size(); }
+    };
+
+    static Graph coarsen(const Graph& graph, std::vector<unsigned int>& fineToCoarse);
+    static unsigned int findPeripheralVertex(
+        const Graph& graph,
+        const std::vector<unsigned int>& vertices,
+        const std::vector<int>& inSubset
+    );
+    static void bisect(
+        const Graph& graph,
+        const std::vector<unsigned int>& vertices,
+        int firstPart,
+        int numParts,
+        std::vector<int>& part
+    );
+    static std::vector<int> growInitialPartition(const Graph& graph, int numParts);
+    static bool keepsDomainConnected(
+        const Graph& graph,
+        const std::vector<int>& part,
+        unsigned int v,
+        std::vector<unsigned int>& visited,
+        unsigned int& stamp
+    );
+    static void refine(const Graph& graph, std::vector<int>& part, int numParts, float maxImbalance);
+    static void mergeDisconnectedFragments(const Graph& graph, std::vector<int>& part, int numParts);
+
+private:
+    Graph m_graph;
+    const std::vector<Edge>& m_edges;
+};
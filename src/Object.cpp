@@ -14,11 +14,21 @@ Object::Object(
       m_shader(std::move(shader)),
       m_mesh(mesh),
       m_texture(texture),
+      m_kinematicPose(1.0f),
       m_isStatic(isStatic),
+      m_enableConvexHullCollider(false),
+      m_enableSelfCollision(false),
+      m_selfCollisionDistance(0.0f),
       m_polygonMode(GL_FILL)
 {
 
     std::vector<glm::vec3>& positions = m_mesh.getPositions();
+    if (m_isStatic)
+    {
+        m_colliderShape = ColliderShape::detect(positions, m_transform.getModelMatrix());
+        m_localPositions = positions;
+    }
+
     glm::mat3 rot = glm::mat3(m_transform.getModelMatrix());
     glm::vec3 trans = glm::vec3(m_transform.getModelMatrix()[3]);
 
@@ -53,6 +63,10 @@ Object::Object(
 
         // create distance constraints
         m_mesh.constructDistanceConstraints();
+        m_selfCollisionDistance = 0.5f * m_mesh.calculateMeanRestEdgeLength();
+
+        // create bending constraints
+        m_mesh.constructBendingConstraints();
 
         // create volume constraints
         m_mesh.constructVolumeConstraints(k);
@@ -82,6 +96,18 @@ void Object::update(float deltaTime)
 
 void Object::resetVertexTransforms()
 {
+    // undo tearing before restoring the initial state
+    if (m_pristineMesh)
+    {
+        m_mesh.restoreTopology(*m_pristineMesh);
+        m_pristineMesh.reset();
+
+        size_t n = m_mesh.getNumPositions();
+        m_initialVertexTransforms.resize(n);
+        m_vertexTransforms.resize(n);
+        m_M.resize(n);
+    }
+
     auto& positions = m_mesh.getPositions();
     auto& initialVertexTransforms = m_initialVertexTransforms;
     size_t n = positions.size();
@@ -96,6 +122,72 @@ void Object::resetVertexTransforms()
     m_mesh.update();
 }
 
+int Object::tear(float tearStrain, int maxTears)
+{
+    if (m_isStatic) return 0;
+
+    // overstretched distance constraints, most strained first
+    const auto& edges = m_mesh.distanceConstraints.edges;
+    std::vector<std::pair<float, size_t>> strained;
+    for (size_t j = 0; j < edges.size(); ++j)
+    {
+        float strain = m_mesh.calculateStrain(j);
+        if (strain > tearStrain)
+        {
+            strained.push_back({ strain, j });
+        }
+    }
+    if (strained.empty()) return 0;
+    std::sort(strained.begin(), strained.end(), std::greater<>());
+
+    int tears = 0;
+    for (const auto& [strain, j] : strained)
+    {
+        if (tears >= maxTears) break;
+
+        // earlier splits may already have relieved this edge
+        if (m_mesh.calculateStrain(j) <= tearStrain) continue;
+
+        // split the endpoint with the larger fan along the plane
+        // perpendicular to the stretch
+        const Edge edge = edges[j];
+        const auto& positions = m_mesh.getPositions();
+        glm::vec3 stretch = glm::normalize(positions[edge.v2] - positions[edge.v1]);
+        unsigned int v = edge.v1;
+        if (m_mesh.getNumAdjacentTriangles(edge.v2) > m_mesh.getNumAdjacentTriangles(edge.v1))
+        {
+            v = edge.v2;
+            stretch = -stretch;
+        }
+
+        if (!m_pristineMesh)
+        {
+            m_pristineMesh = m_mesh;
+        }
+
+        int w = m_mesh.splitVertex(v, stretch);
+        if (w < 0) continue;
+
+        // the new particle starts with the state of the one it split from
+        m_initialVertexTransforms.push_back(m_initialVertexTransforms[v]);
+        m_vertexTransforms.push_back(m_vertexTransforms[v]);
+        m_M.push_back(m_M[v]);
+        tears++;
+    }
+
+    if (tears > 0)
+    {
+        m_mesh.compactAdjacency();
+    }
+    return tears;
+}
+
+void Object::updateKinematicPose(float time)
+{
+    if (!m_kinematicMotion) return;
+    m_kinematicPose = m_kinematicMotion(time);
+}
+
 // TODO : refactoring
 void Object::render()
 {
@@ -122,6 +214,9 @@ void Object::render()
     int viewLoc = glGetUniformLocation(m_shader.getID(), "view");
     glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(m_transform.getViewMatrix()));
 
+    int modelLoc = glGetUniformLocation(m_shader.getID(), "model");
+    glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(m_kinematicPose));
+
     m_mesh.draw();
 
 
@@ -134,6 +229,9 @@ void Object::render()
     viewLoc = glGetUniformLocation(s_vertexNormalShader.getID(), "view");
     glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(m_transform.getViewMatrix()));
 
+    modelLoc = glGetUniformLocation(s_vertexNormalShader.getID(), "model");
+    glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(m_kinematicPose));
+
     m_mesh.drawVertexNormals();
 
 
@@ -146,5 +244,8 @@ void Object::render()
     viewLoc = glGetUniformLocation(s_faceNormalShader.getID(), "view");
     glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(m_transform.getViewMatrix()));
 
+    modelLoc = glGetUniformLocation(s_faceNormalShader.getID(), "model");
+    glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(m_kinematicPose));
+
     m_mesh.drawFaceNormals();
 }
\ No newline at end of file
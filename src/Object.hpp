@@ -6,12 +6,14 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include <functional>
 #include <optional>
 
 #include "Transform.hpp"
 #include "Shader.hpp"
 #include "Mesh.hpp"
 #include "Texture.hpp"
+#include "ColliderShape.hpp"
 
 class Object
 {
@@ -40,11 +42,40 @@ public:
 
     Transform& getTransform() { return m_transform; }
     std::vector<Transform>& getVertexTransforms() { return m_vertexTransforms; }
+    const std::vector<Transform>& getVertexTransforms() const { return m_vertexTransforms; }
+    const std::vector<Transform>& getInitialVertexTransforms() const { return m_initialVertexTransforms; }
     Mesh& getMesh() { return m_mesh; }
+    const Mesh& getMesh() const { return m_mesh; }
     const std::vector<float>& getMass() const { return m_M; }
 
     void resetVertexTransforms();
 
+    // static objects only; the mesh positions before the model matrix was
+    // baked into them
+    const std::vector<glm::vec3>& getLocalPositions() const { return m_localPositions; }
+
+    // static objects only; detected from the mesh unless declared
+    const std::optional<ColliderShape>& getColliderShape() const { return m_colliderShape; }
+    void setColliderShape(const std::optional<ColliderShape>& shape) { m_colliderShape = shape; }
+
+    // static objects only; collide against the convex hull of the mesh even
+    // where the mesh is concave
+    bool& enableConvexHullCollider() { return m_enableConvexHullCollider; }
+
+    // static objects only; a rigid pose over time applied on top of the baked
+    // positions, which the colliders are queried against in their rest frame
+    void setKinematicMotion(std::function<glm::mat4(float)> motion) { m_kinematicMotion = std::move(motion); }
+    bool isKinematic() const { return static_cast<bool>(m_kinematicMotion); }
+    void updateKinematicPose(float time);
+    const glm::mat4& getKinematicPose() const { return m_kinematicPose; }
+
+    // particles closer than the self collision distance push each other apart
+    bool& enableSelfCollision() { return m_enableSelfCollision; }
+    float getSelfCollisionDistance() const { return m_selfCollisionDistance; }
+
+    int tear(float tearStrain, int maxTears);
+    bool isTorn() const { return m_pristineMesh.has_value(); }
+
     static void setVertexNormalShader(const Shader& shader) { s_vertexNormalShader = shader; }
     static void setFaceNormalShader(const Shader& shader)   { s_faceNormalShader   = shader; }
 
@@ -55,11 +86,19 @@ private:
     static Shader s_vertexNormalShader;
     static Shader s_faceNormalShader;
     Mesh m_mesh;
+    std::optional<Mesh> m_pristineMesh;
     std::optional<Texture> m_texture;
+    std::optional<ColliderShape> m_colliderShape;
+    std::function<glm::mat4(float)> m_kinematicMotion;
+    glm::mat4 m_kinematicPose;
     bool m_isStatic;
+    bool m_enableConvexHullCollider;
+    bool m_enableSelfCollision;
+    float m_selfCollisionDistance;
     GLenum m_polygonMode;
 
 
+    std::vector<glm::vec3> m_localPositions;
     std::vector<Transform> m_initialVertexTransforms;
     std::vector<Transform> m_vertexTransforms;
     std::vector<float> m_M;
@@ -0,0 +1,246 @@
+#include "ParticleHash.hpp"
+
+#include <algorithm>
+
+ParticleHash::ParticleHash(float spacing)
+    : m_spacing(spacing),
+      m_invSpacing(1.0f / spacing)
+{
+}
+
+void ParticleHash::setSpacing(float spacing)
+{
+    m_spacing = spacing;
+    m_invSpacing = 1.0f / spacing;
+}
+
+glm::ivec3 ParticleHash::getCell(const glm::vec3& p) const
+{
+    return glm::ivec3(glm::floor(p * m_invSpacing));
+}
+
+size_t ParticleHash::hashCell(int x, int y, int z, size_t tableSize) const
+{
+    uint32_t h = (static_cast<uint32_t>(x) * 73856093u) ^
+                 (static_cast<uint32_t>(y) * 19349663u) ^
+                 (static_cast<uint32_t>(z) * 83492791u);
+    return h & (tableSize - 1);
+}
+
+void ParticleHash::build(const std::vector<glm::vec3>& x)
+{
+    size_t n = x.size();
+    m_tableSize = 1;
+    while (m_tableSize < 2 * n) m_tableSize <<= 1;
+
+    // counting sort by bucket
+    m_particleBuckets.resize(n);
+    m_bucketStart.assign(m_tableSize + 1, 0);
+    for (size_t i = 0; i < n; ++i)
+    {
+        glm::ivec3 cell = getCell(x[i]);
+        m_particleBuckets[i] = hashCell(cell.x, cell.y, cell.z, m_tableSize);
+        m_bucketStart[m_particleBuckets[i] + 1]++;
+    }
+
+    for (size_t b = 0; b < m_tableSize; ++b)
+    {
+        m_bucketStart[b + 1] += m_bucketStart[b];
+    }
+
+    m_entries.resize(n);
+    std::vector<unsigned int> fill(m_bucketStart.begin(), m_bucketStart.end() - 1);
+    for (size_t i = 0; i < n; ++i)
+    {
+        m_entries[fill[m_particleBuckets[i]]++] = static_cast<unsigned int>(i);
+    }
+}
+
+void ParticleHash::buildTriangles(const std::vector<glm::vec3>& x, const std::vector<Triangle>& triangles, float maxDistance)
+{
+    size_t n = triangles.size();
+    m_triangleMin.resize(n);
+    m_triangleMax.resize(n);
+
+    // count cell entries first to size the table
+    size_t numEntries = 0;
+    for (size_t t = 0; t < n; ++t)
+    {
+        const glm::vec3& a = x[triangles[t].v1];
+        const glm::vec3& b = x[triangles[t].v2];
+        const glm::vec3& c = x[triangles[t].v3];
+        m_triangleMin[t] = glm::min(a, glm::min(b, c)) - maxDistance;
+        m_triangleMax[t] = glm::max(a, glm::max(b, c)) + maxDistance;
+
+        glm::ivec3 cells = getCell(m_triangleMax[t]) - getCell(m_triangleMin[t]) + 1;
+        numEntries += static_cast<size_t>(cells.x) * cells.y * cells.z;
+    }
+
+    m_triangleTableSize = 1;
+    while (m_triangleTableSize < 2 * numEntries) m_triangleTableSize <<= 1;
+
+    auto forEachBucket = [this](size_t t, auto visit) {
+        glm::ivec3 lo = getCell(m_triangleMin[t]);
+        glm::ivec3 hi = getCell(m_triangleMax[t]);
+        for (int cx = lo.x; cx <= hi.x; ++cx)
+            for (int cy = lo.y; cy <= hi.y; ++cy)
+                for (int cz = lo.z; cz <= hi.z; ++cz)
+                    visit(hashCell(cx, cy, cz, m_triangleTableSize));
+    };
+
+    // counting sort by bucket
+    m_triangleBucketStart.assign(m_triangleTableSize + 1, 0);
+    for (size_t t = 0; t < n; ++t)
+    {
+        forEachBucket(t, [&](size_t bucket) { m_triangleBucketStart[bucket + 1]++; });
+    }
+
+    for (size_t b = 0; b < m_triangleTableSize; ++b)
+    {
+        m_triangleBucketStart[b + 1] += m_triangleBucketStart[b];
+    }
+
+    m_triangleEntries.resize(numEntries);
+    std::vector<unsigned int> fill(m_triangleBucketStart.begin(), m_triangleBucketStart.end() - 1);
+    for (size_t t = 0; t < n; ++t)
+    {
+        forEachBucket(t, [&](size_t bucket) { m_triangleEntries[fill[bucket]++] = static_cast<unsigned int>(t); });
+    }
+}
+
+void ParticleHash::findTriangleCandidates(const std::vector<glm::vec3>& x, Adjacency& candidates) const
+{
+    // every triangle near a particle is in the bucket of the particle's own cell
+    candidates.gather(x.size(), [&](size_t i, std::vector<unsigned int>& out) {
+        if (m_triangleTableSize == 0) return;
+
+        glm::ivec3 cell = getCell(x[i]);
+        size_t bucket = hashCell(cell.x, cell.y, cell.z, m_triangleTableSize);
+        size_t start = out.size();
+        for (unsigned int e = m_triangleBucketStart[bucket]; e < m_triangleBucketStart[bucket + 1]; ++e)
+        {
+            // different cells can share a bucket, so check the actual bounds
+            unsigned int t = m_triangleEntries[e];
+            if (glm::all(glm::greaterThanEqual(x[i], m_triangleMin[t])) &&
+                glm::all(glm::lessThanEqual(x[i], m_triangleMax[t])))
+            {
+                out.push_back(t);
+            }
+        }
+
+        std::sort(out.begin() + start, out.end());
+        out.erase(std::unique(out.begin() + start, out.end()), out.end());
+    });
+}
+
+template<bool AllPairs, typename Visit>
+void ParticleHash::forEachNeighbour(const std::vector<glm::vec3>& x, unsigned int i, float maxDistance2, Visit visit) const
+{
+    // the 27 surrounding cells can share buckets, visit each bucket once
+    size_t buckets[27];
+    int numBuckets = 0;
+    glm::ivec3 cell = getCell(x[i]);
+    for (int dx = -1; dx <= 1; ++dx)
+    {
+        for (int dy = -1; dy <= 1; ++dy)
+        {
+            for (int dz = -1; dz <= 1; ++dz)
+            {
+                size_t bucket = hashCell(cell.x + dx, cell.y + dy, cell.z + dz, m_tableSize);
+                if (std::find(buckets, buckets + numBuckets, bucket) == buckets + numBuckets)
+                {
+                    buckets[numBuckets++] = bucket;
+                }
+            }
+        }
+    }
+
+    for (int b = 0; b < numBuckets; ++b)
+    {
+        for (unsigned int e = m_bucketStart[buckets[b]]; e < m_bucketStart[buckets[b] + 1]; ++e)
+        {
+            unsigned int j = m_entries[e];
+            if (AllPairs ? j == i : j <= i) continue;
+
+            glm::vec3 d = x[j] - x[i];
+            if (glm::dot(d, d) < maxDistance2) visit(j);
+        }
+    }
+}
+
+void ParticleHash::findNeighbours(
+    const std::vector<glm::vec3>& x,
+    float maxDistance,
+    std::vector<unsigned int>& offsets,
+    std::vector<unsigned int>& neighbours
+) const
+{
+    gatherNeighbours<false>(x, maxDistance, offsets, neighbours);
+}
+
+void ParticleHash::findAllNeighbours(
+    const std::vector<glm::vec3>& x,
+    float maxDistance,
+    std::vector<unsigned int>& offsets,
+    std::vector<unsigned int>& neighbours
+) const
+{
+    gatherNeighbours<true>(x, maxDistance, offsets, neighbours);
+}
+
+template<bool AllPairs>
+void ParticleHash::gatherNeighbours(
+    const std::vector<glm::vec3>& x,
+    float maxDistance,
+    std::vector<unsigned int>& offsets,
+    std::vector<unsigned int>& neighbours
+) const
+{
+    const long long n = static_cast<long long>(x.size());
+    const float maxDistance2 = maxDistance * maxDistance;
+
+    // one traversal per particle into per-thread lists; each thread owns one
+    // contiguous range of particles, so after the prefix sum its list is copied
+    // into place and the result does not depend on threads
+    offsets.assign(n + 1, 0);
+    #pragma omp parallel
+    {
+        std::vector<unsigned int> local;
+        long long first = -1;
+
+        #pragma omp for schedule(static)
+        for (long long i = 0; i < n; ++i)
+        {
+            if (first < 0) first = i;
+
+            size_t start = local.size();
+            forEachNeighbour<AllPairs>(x, static_cast<unsigned int>(i), maxDistance2, [&](unsigned int j) { local.push_back(j); });
+            offsets[i + 1] = static_cast<unsigned int>(local.size() - start);
+        }
+
+        #pragma omp single
+        {
+            for (long long i = 0; i < n; ++i)
+            {
+                offsets[i + 1] += offsets[i];
+            }
+            neighbours.resize(offsets[n]);
+        }
+
+        if (first >= 0)
+        {
+            std::copy(local.begin(), local.end(), neighbours.begin() + offsets[first]);
+        }
+
+        // pairs are solved in index order
+        if (!AllPairs)
+        {
+            #pragma omp barrier
+            #pragma omp for schedule(static)
+            for (long long i = 0; i < n; ++i)
+            {
+                std::sort(neighbours.begin() + offsets[i], neighbours.begin() + offsets[i + 1]);
+            }
+        }
+    }
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "Adjacency.hpp"
+#include "Mesh.hpp"
+
+// Spatial hash over the particles of one object (Teschner et al. 2003), rebuilt
+// every substep. Particles are counting-sorted by bucket into one flat array and
+// neighbour lists are gathered in parallel into CSR arrays. The object's
+// triangles can be hashed alongside, by their bounds, for vertex-triangle tests.
+class ParticleHash
+{
+public:
+    explicit ParticleHash(float spacing = 1.0f);
+
+    void setSpacing(float spacing);
+    float getSpacing() const { return m_spacing; }
+
+    void build(const std::vector<glm::vec3>& x);
+
+    // pairs (i, j) with i < j closer than maxDistance, which must not exceed
+    // the spacing; particle i's partners are neighbours[offsets[i] .. offsets[i + 1])
+    void findNeighbours(
+        const std::vector<glm::vec3>& x,
+        float maxDistance,
+        std::vector<unsigned int>& offsets,
+        std::vector<unsigned int>& neighbours
+    ) const;
+
+    // every particle closer than maxDistance to particle i, in any order, for
+    // solvers that gather over neighbours rather than scatter over pairs
+    void findAllNeighbours(
+        const std::vector<glm::vec3>& x,
+        float maxDistance,
+        std::vector<unsigned int>& offsets,
+        std::vector<unsigned int>& neighbours
+    ) const;
+
+    // enters each triangle into every cell its bounds, grown by maxDistance,
+    // overlap; the cells are those of the particle table
+    void buildTriangles(const std::vector<glm::vec3>& x, const std::vector<Triangle>& triangles, float maxDistance);
+
+    // row i lists the triangles whose grown bounds contain particle i, sorted
+    void findTriangleCandidates(const std::vector<glm::vec3>& x, Adjacency& candidates) const;
+
+private:
+    glm::ivec3 getCell(const glm::vec3& p) const;
+    size_t hashCell(int x, int y, int z, size_t tableSize) const;
+
+    template<bool AllPairs, typename Visit>
+    void forEachNeighbour(const std::vector<glm::vec3>& x, unsigned int i, float maxDistance2, Visit visit) const;
+
+    template<bool AllPairs>
+    void gatherNeighbours(
+        const std::vector<glm::vec3>& x,
+        float maxDistance,
+        std::vector<unsigned int>& offsets,
+        std::vector<unsigned int>& neighbours
+    ) const;
+
+private:
+    float m_spacing;
+    float m_invSpacing;
+
+    // bucket b holds m_entries[m_bucketStart[b] .. m_bucketStart[b + 1])
+    size_t m_tableSize = 0;
+    std::vector<unsigned int> m_bucketStart;
+    std::vector<unsigned int> m_entries;
+    std::vector<size_t> m_particleBuckets;
+
+    // triangle bucket b holds m_triangleEntries[m_triangleBucketStart[b] .. m_triangleBucketStart[b + 1])
+    size_t m_triangleTableSize = 0;
+    std::vector<unsigned int> m_triangleBucketStart;
+    std::vector<unsigned int> m_triangleEntries;
+    std::vector<glm::vec3> m_triangleMin;
+    std::vector<glm::vec3> m_triangleMax;
+};
@@ -8,10 +8,12 @@ void framebufferSizeCallback(GLFWwindow* window, int width, int height)
 PhysicsEngine::PhysicsEngine(
     const char* engineName,
     int screenWidth,
-    int screenHeight
+    int screenHeight,
+    int workerProcesses
 )
     : m_screenWidth(screenWidth),
-      m_screenHeight(screenHeight)
+      m_screenHeight(screenHeight),
+      m_workerProcesses(workerProcesses)
 {
     std::cout << "Initialize: " << engineName << '\n';
 
@@ -80,6 +82,16 @@ PhysicsEngine::PhysicsEngine(
         "../res/shaders/sphere.vsh",
         "../res/shaders/sphere.fsh"
     ));
+    shaders.push_back(std::make_unique<Shader>(
+        "fluid",
+        "../res/shaders/fluid.vsh",
+        "../res/shaders/fluid.fsh"
+    ));
+    shaders.push_back(std::make_unique<Shader>(
+        "cloth",
+        "../res/shaders/cloth.vsh",
+        "../res/shaders/cloth.fsh"
+    ));
     shaderManager->addResources(std::move(shaders));
 
 
@@ -123,14 +135,16 @@ PhysicsEngine::PhysicsEngine(
         m_window
     );
 
-    // create scene
+    // create scene; with worker processes, dynamic objects are simulated in
+    // separate processes
     // TODO : REFACTOR SUCH THAT IT CAN CREATE MULTIPLE SCENE ENVIRONMENTS THAT CAN BE SELECTED
     m_scene = std::make_unique<Scene>(
         "Test Scene",
         std::move(shaderManager),
         std::move(meshManager),
         std::move(textureManager),
-        std::move(camera)
+        std::move(camera),
+        m_workerProcesses
     );
 
 
@@ -17,7 +17,8 @@ public:
     PhysicsEngine(
         const char* engineName,
         int screenWidth,
-        int screenHeight
+        int screenHeight,
+        int workerProcesses = 0
     );
 
     bool isRunning() const { return m_isRunning; }
@@ -32,6 +33,7 @@ private:
     GLFWwindow* m_window;
 
     const int m_targetFPS = 60;
+    int m_workerProcesses;
     std::unique_ptr<Timer> m_timer;
 
     std::unique_ptr<DebugWindow> m_debugWindow;
@@ -12,6 +12,8 @@ void Scene::createObjects()
     Shader lightShader = m_shaderManager->getResource("light");
     Shader dirtBlockShader = m_shaderManager->getResource("dirtblock");
     Shader sphereShader = m_shaderManager->getResource("sphere");
+    Shader fluidShader = m_shaderManager->getResource("fluid");
+    Shader clothShader = m_shaderManager->getResource("cloth");
 
     Mesh cubeMesh = m_meshManager->getResource("cube");
     Mesh sphereMesh = m_meshManager->getResource("sphere");
@@ -54,9 +56,123 @@ void Scene::createObjects()
             platformShader,
             cubeMesh
         );
+
+        // nothing reaches the floor from below, so its top face is all that
+        // collides
+        if (def.name == "Platform")
+        {
+            glm::vec3 top = glm::vec3(model * glm::vec4(0.0f, 1.0f, 0.0f, 1.0f));
+            platformBlock->setColliderShape(ColliderShape::makePlane(glm::vec3(model[1]), top));
+        }
         m_objects.push_back(std::move(platformBlock));
     }
 
+    // lift spinning about its centre while it slides across the floor
+    glm::vec3 liftPosition(0.0f, 1.5f, 12.0f);
+    Transform liftTransform;
+    liftTransform.setProjection(*m_camera);
+    liftTransform.setModel(glm::scale(glm::translate(glm::mat4(1.0f), liftPosition), glm::vec3(4.0f, 0.5f, 4.0f)));
+    liftTransform.setView(*m_camera);
+
+    auto lift = std::make_unique<Object>(
+        "Lift",
+        liftTransform,
+        m_k,
+        platformShader,
+        cubeMesh
+    );
+    lift->setKinematicMotion([liftPosition](float time)
+    {
+        glm::vec3 offset(20.0f * std::sin(0.5f * time), 0.0f, 0.0f);
+        glm::mat4 pose = glm::translate(glm::mat4(1.0f), liftPosition + offset);
+        pose = glm::rotate(pose, 0.8f * time, glm::vec3(0.0f, 1.0f, 0.0f));
+        return glm::translate(pose, -liftPosition);
+    });
+    m_objects.push_back(std::move(lift));
+
+    // terrain behind the back wall
+    int terrainNumX;
+    int terrainNumZ;
+    std::vector<float> terrainHeights = Heightfield::loadImage("../res/heightmaps/terrain.png", terrainNumX, terrainNumZ);
+    if (!terrainHeights.empty())
+    {
+        Transform terrainTransform;
+        terrainTransform.setProjection(*m_camera);
+        terrainTransform.setView(*m_camera);
+
+        m_heightfields.push_back(std::make_unique<Heightfield>(
+            "Terrain",
+            terrainTransform,
+            platformShader,
+            std::move(terrainHeights),
+            terrainNumX,
+            terrainNumZ,
+            glm::vec3(-40.0f, -0.5f, -80.0f),
+            glm::vec3(80.0f, 8.0f, 59.0f)
+        ));
+    }
+
+    // water in the far corner, away from where the sphere lands
+    Transform waterTransform;
+    waterTransform.setProjection(*m_camera);
+    waterTransform.setView(*m_camera);
+
+    auto water = std::make_unique<FluidSystem>(
+        "Water",
+        waterTransform,
+        fluidShader,
+        0.2f
+    );
+    water->addBlock(glm::vec3(-39.0f, 0.0f, -19.0f), glm::vec3(-31.0f, 1.6f, -13.0f));
+    m_fluids.push_back(std::move(water));
+
+    // flag pinned at two corners, next to the foot of the lower ramp
+    Transform flagTransform;
+    flagTransform.setProjection(*m_camera);
+    flagTransform.setView(*m_camera);
+    flagTransform.setModel(glm::translate(glm::mat4(1.0f), glm::vec3(25.0f, 8.0f, -12.0f)));
+
+    auto flag = std::make_unique<Cloth>(
+        "Flag",
+        flagTransform,
+        clothShader,
+        48,
+        48,
+        6.0f,
+        6.0f,
+        2.0f
+    );
+    flag->pin(0, 0);
+    flag->pin(47, 0);
+    m_cloths.push_back(std::move(flag));
+
+    // posts either side of the flag, collided as capsules
+    const float postRadius = 0.3f;
+    const float postHeight = 8.0f;
+    for (float postX : { 21.4f, 28.6f })
+    {
+        Transform postTransform;
+        postTransform.setProjection(*m_camera);
+        glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(postX, 0.5f * postHeight, -15.0f));
+        model = glm::scale(model, glm::vec3(postRadius, 0.5f * postHeight, postRadius));
+        postTransform.setModel(model);
+        postTransform.setView(*m_camera);
+
+        auto post = std::make_unique<Object>(
+            "Post",
+            postTransform,
+            m_k,
+            platformShader,
+            cubeMesh
+        );
+        post->setColliderShape(ColliderShape::makeCapsule(
+            glm::vec3(postX, 0.0f, -15.0f),
+            glm::vec3(postX, postHeight - postRadius, -15.0f),
+            postRadius
+        ));
+        m_objects.push_back(std::move(post));
+    }
+
     // // dirtBlock
     // Transform dirtBlockTransform;
     // dirtBlockTransform.setProjection(*m_camera);
@@ -172,252 +288,1373 @@ void Scene::setupEnvCollisionConstraints()
     }
 }
 
-Scene::Scene(
-    const std::string& name,
-    std::unique_ptr<ShaderManager> shaderManager,
-    std::unique_ptr<MeshManager> meshManager,
-    std::unique_ptr<TextureManager> textureManager,
-    std::unique_ptr<Camera> camera
-)
-    :   m_name(name),
-        m_shaderManager(std::move(shaderManager)),
-        m_meshManager(std::move(meshManager)),
-        m_textureManager(std::move(textureManager)),
-        m_camera(std::move(camera)),
-        m_gravitationalAcceleration(0.0f),
-        m_enableDistanceConstraints(true),
-        m_enableVolumeConstraints(true),
-        m_enableEnvCollisionConstraints(true),
-        m_pbdSubsteps(10),
-        m_alpha(0.001f),
-        m_beta(5.0f),
-        m_k(1.0f)
+// kinematic colliders are queried in the frame their baked geometry rests in
+glm::vec3 Scene::toRestFrame(const glm::mat4& pose, const glm::vec3& p)
 {
-    createObjects();
-    setupEnvCollisionConstraints();
+    return glm::transpose(glm::mat3(pose)) * (p - glm::vec3(pose[3]));
+}
 
-    std::cout << name << " created.\n";
+glm::vec3 Scene::fromRestFrame(const glm::mat4& pose, const glm::vec3& p)
+{
+    return glm::mat3(pose) * p + glm::vec3(pose[3]);
 }
 
-void Scene::applyGravity(
-    Object& object,
-    float deltaTime
-)
+// box around the posed corners of [min, max]
+void Scene::transformBounds(const glm::mat4& pose, glm::vec3& min, glm::vec3& max)
 {
-    for (auto& vertexTransform : object.getVertexTransforms())
+    glm::mat3 rotation(pose);
+    glm::mat3 absRotation(glm::abs(rotation[0]), glm::abs(rotation[1]), glm::abs(rotation[2]));
+    glm::vec3 center = fromRestFrame(pose, 0.5f * (min + max));
+    glm::vec3 extent = absRotation * (0.5f * (max - min));
+    min = center - extent;
+    max = center + extent;
+}
+
+void Scene::buildStaticColliders()
+{
+    // static objects have their model matrix baked into the positions
+    m_envCollisionGrid.clear();
+    m_staticColliders.clear();
+    m_staticColliderTree.clear();
+    for (const auto& obj : m_objects)
     {
-        vertexTransform.setAcceleration(m_gravitationalAcceleration);
+        if (!obj->isStatic()) continue;
+
+        Mesh& mesh = obj->getMesh();
+        const auto& positions = mesh.getPositions();
+        const auto& triangles = mesh.volumeConstraints.triangles;
+        m_envCollisionGrid.addCollider(&mesh, positions, triangles);
+
+        // split the model matrix into rotation, translation and scale; the
+        // SDF is baked from the scaled local mesh
+        glm::mat4 model = obj->getTransform().getModelMatrix();
+        glm::vec3 scale(glm::length(glm::vec3(model[0])), glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2])));
+        glm::mat3 rotation(
+            glm::vec3(model[0]) / scale.x,
+            glm::vec3(model[1]) / scale.y,
+            glm::vec3(model[2]) / scale.z
+        );
+        glm::vec3 translation = glm::vec3(model[3]);
+
+        // meshes without an analytic shape collide against their hull if they
+        // are convex, or if the object accepts losing its concavities
+        std::optional<ConvexHull> hull;
+        if (!obj->getColliderShape())
+        {
+            ConvexHull candidate(positions);
+            if (obj->enableConvexHullCollider() || candidate.isSurfaceOf(positions))
+            {
+                hull = std::move(candidate);
+            }
+        }
+
+        TriangleBVH bvh(positions, triangles);
+        int proxy = -1;
+        if (!bvh.empty())
+        {
+            glm::vec3 min = bvh.getMin();
+            glm::vec3 max = bvh.getMax();
+            transformBounds(obj->getKinematicPose(), min, max);
+            proxy = m_staticColliderTree.createProxy(min, max, static_cast<int>(m_staticColliders.size()));
+        }
+
+        m_staticColliders.push_back({
+            obj.get(),
+            std::move(bvh),
+            getSignedDistanceField(obj->getLocalPositions(), triangles, scale),
+            obj->getColliderShape(),
+            std::move(hull),
+            rotation,
+            translation,
+            model,
+            obj->isKinematic(),
+            obj->getKinematicPose(),
+            obj->getKinematicPose(),
+            proxy
+        });
     }
+    m_envCollisionGrid.build();
 }
 
-float Scene::calculateDeltaLambda(
-    float C_j,
-    const std::vector<glm::vec3>& gradC_j,
-    const std::vector<glm::vec3>& posDiff,
-    std::span<const unsigned int> constraintVertices,
-    const std::vector<float>& M,
-    float alphaTilde,
-    float gamma
-)
+void Scene::buildSoftBodyColliders()
 {
-    float gradCMInverseGradCT = 0.0f;
-    float gradCPosDiff = 0.0f;
-    size_t n = constraintVertices.size();
-
-    for (size_t i = 0; i < n; ++i)
+    m_softBodyTree.clear();
+    m_softBodyColliders.clear();
+    m_softBodyColliderIndices.clear();
+    for (const auto& obj : m_objects)
     {
-        unsigned int v = constraintVertices[i];
-        float w = 1.0f / M[v];
-        gradCMInverseGradCT += w * glm::dot(gradC_j[i], gradC_j[i]);
-        gradCPosDiff += glm::dot(gradC_j[i], posDiff[v]);
-    }
+        if (obj->isStatic()) continue;
 
-    return (-C_j - gamma * gradCPosDiff) / ((1 + gamma) * gradCMInverseGradCT + alphaTilde);
+        Mesh& mesh = obj->getMesh();
+        const auto& positions = mesh.getPositions();
+
+        float inverseMass = 0.0f;
+        for (float m : obj->getMass())
+        {
+            inverseMass += 1.0f / m;
+        }
+        inverseMass /= std::max<size_t>(obj->getMass().size(), 1);
+
+        size_t index = m_softBodyColliders.size();
+        TriangleBVH bvh(positions, mesh.volumeConstraints.triangles);
+        if (bvh.empty()) continue;
+
+        int proxy = m_softBodyTree.createProxy(bvh.getMin(), bvh.getMax(), static_cast<int>(index));
+        m_softBodyColliders.push_back({ obj.get(), proxy, std::move(bvh), positions.size(), inverseMass });
+        m_softBodyColliderIndices[obj.get()] = index;
+    }
 }
 
-std::vector<glm::vec3> Scene::calculateDeltaX(
-    float lambda,
-    const std::vector<float>& M,
-    std::vector<glm::vec3>& gradC_j,
-    std::span<const unsigned int> constraintVertices
-)
+void Scene::refitSoftBodyCollider(Object& object)
 {
-    std::vector<glm::vec3> deltaX(M.size(), glm::vec3(0.0f));
-    size_t n = constraintVertices.size();
-    for (size_t i = 0; i < n; ++i)
+    auto it = m_softBodyColliderIndices.find(&object);
+    if (it == m_softBodyColliderIndices.end()) return;
+
+    // worker processes only keep the vertex transforms up to date
+    SoftBodyCollider& collider = m_softBodyColliders[it->second];
+    const auto& vertexTransforms = object.getVertexTransforms();
+    std::vector<glm::vec3>& positions = m_refitPositions;
+    positions.resize(vertexTransforms.size());
+    for (size_t i = 0; i < positions.size(); ++i)
     {
-        unsigned int v = constraintVertices[i];
-        float w = 1.0f / M[v];
-        deltaX[v] = lambda * w * gradC_j[i];
+        positions[i] = vertexTransforms[i].getPosition();
     }
 
-    return deltaX;
+    // tearing adds particles and rewires triangles, so the tree is rebuilt
+    if (positions.size() != collider.numPositions)
+    {
+        collider.bvh = TriangleBVH(positions, object.getMesh().volumeConstraints.triangles);
+        collider.numPositions = positions.size();
+    }
+    else
+    {
+        collider.bvh.refit(positions);
+    }
+    m_softBodyTree.moveProxy(collider.proxy, collider.bvh.getMin(), collider.bvh.getMax());
 }
 
-void Scene::solveDistanceConstraints(
+void Scene::solveSoftBodyCollisions(
+    const Object& object,
     std::vector<glm::vec3>& x,
     const std::vector<glm::vec3>& posDiff,
     const std::vector<float>& M,
     float alphaTilde,
-    float gamma,
-    const Mesh::DistanceConstraints& distanceConstraints
+    float gamma
 )
 {
-    size_t edgesSize = distanceConstraints.edges.size();
-    size_t CSize = distanceConstraints.C.size();
-    size_t gradCSize = distanceConstraints.gradC.size();
-    if (edgesSize != gradCSize)
+    auto it = m_softBodyColliderIndices.find(&object);
+    if (it == m_softBodyColliderIndices.end()) return;
+    const int self = static_cast<int>(it->second);
+
+    // bodies are stepped one after another, each through all of its substeps,
+    // so the others hold still meanwhile: bodies stepped earlier are where they
+    // end this frame, later ones where they start it. Their trees are refit
+    // once after they are stepped, as refitting them per substep would not
+    // move them; the contact lags by up to one frame
+
+    // swept bounds of this substep
+    glm::vec3 min(std::numeric_limits<float>::max());
+    glm::vec3 max(-std::numeric_limits<float>::max());
+    for (size_t i = 0; i < x.size(); ++i)
     {
-        std::cerr << "DistanceConstraints size mismatch:\n"
-                  << "constraints = " << CSize << ", "
-                  << "gradConstraints = " << gradCSize << ", "
-                  << "edgeVertices = " << edgesSize << std::endl;
-        return;
+        glm::vec3 p = x[i] - posDiff[i];
+        min = glm::min(min, glm::min(p, x[i]));
+        max = glm::max(max, glm::max(p, x[i]));
     }
+    m_softBodyTree.moveProxy(m_softBodyColliders[self].proxy, min, max);
 
-    for (size_t j = 0; j < distanceConstraints.edges.size(); ++j)
+    std::vector<int> overlapping;
+    m_softBodyTree.query(min, max, overlapping);
+    for (int other : overlapping)
     {
-        float C_j = distanceConstraints.C[j](x);
-        std::vector<glm::vec3> gradC_j = distanceConstraints.gradC[j](x);
-        const Edge& edge = distanceConstraints.edges[j];
-        const std::array<unsigned int, 2> constraintVertices = { edge.v1, edge.v2 };
+        if (other == self) continue;
 
-        float deltaLambda = calculateDeltaLambda(C_j, gradC_j, posDiff, constraintVertices, M, alphaTilde, gamma);
-        std::vector<glm::vec3> deltaX = calculateDeltaX(deltaLambda, M, gradC_j, constraintVertices);
+        const SoftBodyCollider& collider = m_softBodyColliders[other];
+        const glm::vec3& colliderMin = collider.bvh.getMin();
+        const glm::vec3& colliderMax = collider.bvh.getMax();
+        for (unsigned int vertex = 0; vertex < x.size(); ++vertex)
+        {
+            if (glm::any(glm::lessThan(x[vertex], colliderMin)) || glm::any(glm::greaterThan(x[vertex], colliderMax))) continue;
+
+            glm::vec3 normal;
+            float depth;
+            if (!collider.bvh.findContact(x[vertex], normal, depth)) continue;
+
+            // the other body resolves its own particles against this one, so
+            // each side only takes its mass-weighted share of the depth
+            float w = 1.0f / M[vertex];
+            float share = w / (w + collider.inverseMass);
+
+            float C_j = -share * depth;
+            std::vector<glm::vec3> gradC_j = { normal };
+            std::array<unsigned int, 1> constraintVertices = { vertex };
+
+            float deltaLambda = calculateDeltaLambda(C_j, gradC_j, posDiff, constraintVertices, M, alphaTilde, gamma);
+            applyDeltaX(x, deltaLambda, M, gradC_j, constraintVertices);
+        }
+    }
+}
+
+void Scene::gatherContacts(
+    const Object& object,
+    float deltaTime,
+    std::vector<Contact>& contacts
+)
+{
+    contacts.clear();
+    if (m_staticColliders.empty() && m_heightfields.empty()) return;
+
+    const auto& vertexTransforms = object.getVertexTransforms();
+    const size_t numVerts = vertexTransforms.size();
+
+    // GJK restarts from the simplex each particle ended with last frame
+    std::vector<ConvexHull::Simplex>& simplices = m_hullSimplices[&object];
+    simplices.resize(m_staticColliders.size() * numVerts);
+
+    // each thread scans a contiguous range of particles into its own buffer;
+    // concatenating the buffers in thread order gives particle order for any
+    // number of threads
+    #pragma omp parallel
+    {
+        const size_t numThreads = static_cast<size_t>(omp_get_num_threads());
+        const size_t thread = static_cast<size_t>(omp_get_thread_num());
+
+        #pragma omp single
+        {
+            m_contactBuffers.resize(numThreads);
+            m_contactOffsets.assign(numThreads + 1, 0);
+        }
+
+        std::vector<Contact>& buffer = m_contactBuffers[thread];
+        buffer.clear();
+
+        size_t begin = numVerts * thread / numThreads;
+        size_t end = numVerts * (thread + 1) / numThreads;
+        for (size_t vertex = begin; vertex < end; ++vertex)
+        {
+            // a particle can only reach colliders within the distance it may
+            // travel this frame
+            const Transform& vertexTransform = vertexTransforms[vertex];
+            const glm::vec3& position = vertexTransform.getPosition();
+            glm::vec3 velocity = vertexTransform.getVelocity() + deltaTime * vertexTransform.getAcceleration();
+            float margin = glm::length(velocity) * deltaTime + m_contactMargin;
+
+            for (size_t c = 0; c < m_staticColliders.size(); ++c)
+            {
+                const StaticCollider& collider = m_staticColliders[c];
+
+                // moving colliders are queried where they start the step, with
+                // the margin widened by how far the queried point travels
+                glm::vec3 query = position;
+                float colliderMargin = margin;
+                if (collider.isKinematic)
+                {
+                    query = toRestFrame(collider.previousPose, position);
+                    colliderMargin += glm::length(fromRestFrame(collider.pose, query) - position);
+                }
+
+                if (glm::any(glm::lessThan(query + colliderMargin, collider.bvh.getMin())) ||
+                    glm::any(glm::greaterThan(query - colliderMargin, collider.bvh.getMax())))
+                {
+                    continue;
+                }
+
+                // contact planes on a kinematic collider translate with the
+                // point they were found at; rotation within a step is ignored
+                auto addContact = [&](const glm::vec3& point, const glm::vec3& normal)
+                {
+                    if (!collider.isKinematic)
+                    {
+                        buffer.push_back({ static_cast<unsigned int>(vertex), point, normal });
+                        return;
+                    }
+
+                    glm::vec3 start = fromRestFrame(collider.previousPose, point);
+                    glm::vec3 end = fromRestFrame(collider.pose, point);
+                    buffer.push_back({
+                        static_cast<unsigned int>(vertex),
+                        start,
+                        glm::mat3(collider.previousPose) * normal,
+                        (end - start) / deltaTime
+                    });
+                };
+
+                // the same geometry the per-substep path tests, each reduced to
+                // one separating plane per particle
+                if (collider.shape && m_enableAnalyticColliders)
+                {
+                    glm::vec3 normal(0.0f, 1.0f, 0.0f);
+                    float depth = -std::numeric_limits<float>::max();
+                    collider.shape->findContact(query, normal, depth);
+                    if (-depth >= colliderMargin) continue;
+
+                    addContact(query + depth * normal, normal);
+                    continue;
+                }
+
+                if (collider.hull && m_enableConvexHullColliders)
+                {
+                    ConvexHull::Simplex& simplex = simplices[c * numVerts + vertex];
+                    glm::vec3 closest;
+                    if (collider.hull->findClosestPoint(query, simplex, closest))
+                    {
+                        float distance = glm::length(query - closest);
+                        if (distance >= colliderMargin) continue;
+
+                        addContact(closest, (query - closest) / distance);
+                        continue;
+                    }
+
+                    glm::vec3 normal;
+                    float depth;
+                    if (!collider.hull->findContact(query, normal, depth)) continue;
+
+                    addContact(query + depth * normal, normal);
+                    continue;
+                }
 
+                if (collider.sdf && m_enableColliderSDF)
+                {
+                    glm::vec3 gradient;
+                    glm::vec3 local = glm::transpose(collider.rotation) * (query - collider.translation);
+                    float distance = collider.sdf->sample(local, gradient);
+                    float length = glm::length(gradient);
+                    if (distance >= colliderMargin || length < 1e-6f) continue;
+
+                    glm::vec3 normal = collider.rotation * (gradient / length);
+                    addContact(query - distance * normal, normal);
+                    continue;
+                }
+
+                TriangleBVH::ClosestPoint closest;
+                if (!collider.bvh.findClosestPoint(query, closest, colliderMargin)) continue;
+                if (closest.distance >= colliderMargin) continue;
+
+                // the plane separates the particle from the closest feature;
+                // particles already inside are pushed out through it
+                glm::vec3 d = query - closest.point;
+                float length = glm::length(d);
+                glm::vec3 normal = closest.normal;
+                if (length > 1e-6f)
+                {
+                    normal = (closest.distance < 0.0f ? -d : d) / length;
+                }
+
+                addContact(closest.point, normal);
+            }
+
+            // the terrain below the particle, as its tangent plane
+            for (const auto& heightfield : m_heightfields)
+            {
+                if (!heightfield->contains(position.x, position.z)) continue;
+
+                float height = heightfield->getHeight(position.x, position.z);
+                if (position.y - height >= margin) continue;
+
+                glm::vec3 point(position.x, height, position.z);
+                buffer.push_back({ static_cast<unsigned int>(vertex), point, heightfield->getNormal(position.x, position.z) });
+            }
+        }
+        m_contactOffsets[thread + 1] = buffer.size();
+
+        // prefix sum, then every thread copies its buffer into place
+        #pragma omp barrier
+        #pragma omp single
         {
-            for (size_t k = 0; k < deltaX.size(); ++k)
+            for (size_t t = 0; t < numThreads; ++t)
             {
-                x[k] += deltaX[k];
+                m_contactOffsets[t + 1] += m_contactOffsets[t];
             }
+            contacts.resize(m_contactOffsets[numThreads]);
         }
 
+        std::copy(buffer.begin(), buffer.end(), contacts.begin() + m_contactOffsets[thread]);
     }
 }
 
-void Scene::solveVolumeConstraints(
+void Scene::solveContacts(
     std::vector<glm::vec3>& x,
     const std::vector<glm::vec3>& posDiff,
     const std::vector<float>& M,
     float alphaTilde,
     float gamma,
-    const Mesh::VolumeConstraints& volumeConstraints
+    std::vector<Contact>& contacts,
+    float time
 )
 {
-    size_t trianglesSize = volumeConstraints.triangles.size();
-    size_t CSize = volumeConstraints.C.size();
-    size_t gradCSize = volumeConstraints.gradC.size();
-    if (trianglesSize != gradCSize)
+    // time since the contacts were gathered
+    for (Contact& contact : contacts)
     {
-        std::cerr << "VolumeConstraints size mismatch:\n"
-                  << "constraints = " << CSize << ", "
-                  << "gradConstraints = " << gradCSize << ", "
-                  << "triangleVertices = " << trianglesSize << std::endl;
-        return;
+        glm::vec3 point = contact.point + time * contact.velocity;
+        float C_j = glm::dot(contact.normal, x[contact.vertex] - point);
+        contact.depth = std::max(-C_j, 0.0f);
+        if (C_j >= 0.0f) continue;
+
+        std::vector<glm::vec3> gradC_j = { contact.normal };
+        std::array<unsigned int, 1> constraintVertices = { contact.vertex };
+
+        float deltaLambda = calculateDeltaLambda(C_j, gradC_j, posDiff, constraintVertices, M, alphaTilde, gamma);
+        applyDeltaX(x, deltaLambda, M, gradC_j, constraintVertices);
     }
+}
 
-    for (size_t j = 0; j < volumeConstraints.triangles.size(); ++j)
+void Scene::solveContactVelocities(
+    std::vector<glm::vec3>& v,
+    const std::vector<glm::vec3>& posDiff,
+    const std::vector<Contact>& contacts,
+    float deltaTime_s
+)
+{
+    // approaches slower than gravity adds in one substep come to rest instead
+    // of bouncing, so resting contacts don't jitter
+    float restingSpeed = 2.0f * glm::length(m_gravitationalAcceleration) * deltaTime_s;
+
+    for (const Contact& contact : contacts)
     {
-        float C_j = volumeConstraints.C[0](x);
-        std::vector<glm::vec3> gradC_j = volumeConstraints.gradC[j](x);
-        const Triangle& tri = volumeConstraints.triangles[j];
-        const std::array<unsigned int, 3> constraintVertices = { tri.v1, tri.v2, tri.v3 };
+        if (contact.depth <= 0.0f) continue;
 
-        float deltaLambda = calculateDeltaLambda(C_j, gradC_j, posDiff, constraintVertices, M, alphaTilde, gamma);
-        std::vector<glm::vec3> deltaX = calculateDeltaX(deltaLambda, M, gradC_j, constraintVertices);
+        glm::vec3 relativeV = v[contact.vertex] - contact.velocity;
+        float vn = glm::dot(contact.normal, relativeV);
+        glm::vec3 vt = relativeV - vn * contact.normal;
 
-        for (size_t k = 0; k < deltaX.size(); ++k)
+        // the tangential change is bounded by the normal correction, which is
+        // the normal impulse per unit mass times the substep
+        float vtLength = glm::length(vt);
+        glm::vec3 deltaV(0.0f);
+        if (vtLength > 1e-6f)
         {
-            x[k] += deltaX[k];
+            deltaV -= (std::min(m_friction * contact.depth / deltaTime_s, vtLength) / vtLength) * vt;
         }
+
+        // restitution against the normal velocity before the substep's solve
+        float vnBefore = glm::dot(contact.normal, posDiff[contact.vertex] / deltaTime_s - contact.velocity);
+        float restitution = -vnBefore > restingSpeed ? m_restitution : 0.0f;
+        deltaV += (std::max(-restitution * vnBefore, 0.0f) - vn) * contact.normal;
+
+        v[contact.vertex] += deltaV;
     }
 }
 
-void Scene::solveEnvCollisionConstraints(
+void Scene::solveContinuousCollisions(
     std::vector<glm::vec3>& x,
     const std::vector<glm::vec3>& posDiff,
     const std::vector<float>& M,
     float alphaTilde,
-    float gamma,
-    std::vector<Mesh::EnvCollisionConstraints> perEnvCollisionConstraints
+    float gamma
 )
 {
-    for (size_t setIdx = 0; setIdx < perEnvCollisionConstraints.size(); ++setIdx)
+    // only fast particles can cross a collider within one substep
+    const float threshold2 = m_continuousCollisionThreshold * m_continuousCollisionThreshold;
+    for (unsigned int vertex = 0; vertex < x.size(); ++vertex)
     {
-        const auto& constraints = perEnvCollisionConstraints[setIdx];
-        size_t verticesSize = constraints.vertices.size();
-        size_t CSize = constraints.C.size();
-        size_t gradCSize = constraints.gradC.size();
-
-        if (verticesSize != gradCSize)
-        {
-            std::cerr << "EnvCollisionConstraints size mismatch in set " << setIdx << std::endl;
-            continue;
-        }
-
-        for (const auto& [vertex, constraintIndices] : constraints.vertexToConstraints)
+        const glm::vec3& motion = posDiff[vertex];
+        float length2 = glm::dot(motion, motion);
+        if (length2 <= threshold2) continue;
+
+        float length = std::sqrt(length2);
+        glm::vec3 p = x[vertex] - motion;
+        glm::vec3 direction = motion / length;
+        glm::vec3 sweptMin = glm::min(p, x[vertex]);
+        glm::vec3 sweptMax = glm::max(p, x[vertex]);
+
+        // earliest face the particle enters along its motion
+        TriangleBVH::RayHit earliest;
+        earliest.t = length;
+        bool found = false;
+        for (const auto& collider : m_staticColliders)
         {
-            bool allNegative = true;
-            float maxNegativeC = -std::numeric_limits<float>::max(); // Initialize to most negative possible value
-            size_t maxIdx = 0;
-            for (size_t idx : constraintIndices)
+            if (collider.isKinematic)
             {
-                float C_j = constraints.C[idx](x);
-                if (C_j >= 0.0f)
+                // the ray is cast against the collider's current pose
+                glm::vec3 origin = toRestFrame(collider.pose, p);
+                glm::vec3 end = toRestFrame(collider.pose, x[vertex]);
+                if (glm::any(glm::lessThan(glm::max(origin, end), collider.bvh.getMin())) ||
+                    glm::any(glm::greaterThan(glm::min(origin, end), collider.bvh.getMax())))
                 {
-                    allNegative = false;
+                    continue;
                 }
 
-                // Track the constraint with biggest negative value
-                if (C_j < 0.0f && C_j > maxNegativeC)
+                TriangleBVH::RayHit hit;
+                glm::vec3 restDirection = glm::transpose(glm::mat3(collider.pose)) * direction;
+                if (collider.bvh.raycast(origin, restDirection, earliest.t, hit) && glm::dot(hit.normal, restDirection) < 0.0f)
                 {
-                    maxNegativeC = C_j;
-                    maxIdx = idx;
+                    hit.point = fromRestFrame(collider.pose, hit.point);
+                    hit.normal = glm::mat3(collider.pose) * hit.normal;
+                    earliest = hit;
+                    found = true;
                 }
+                continue;
             }
 
-            // If all constraints are negative, we have a collision with this vertex
-            if (allNegative && !constraintIndices.empty())
+            if (glm::any(glm::lessThan(sweptMax, collider.bvh.getMin())) ||
+                glm::any(glm::greaterThan(sweptMin, collider.bvh.getMax())))
             {
-                float C_j = maxNegativeC;
-                std::vector<glm::vec3> gradC_j = constraints.gradC[maxIdx](x);
-
-                std::array<unsigned int, 1> constraintVertices = { vertex };
-
-                float deltaLambda = calculateDeltaLambda(C_j, gradC_j, posDiff, constraintVertices, M, alphaTilde, gamma);
-                std::vector<glm::vec3> deltaX = calculateDeltaX(deltaLambda, M, gradC_j, constraintVertices);
+                continue;
+            }
 
-                for (size_t k = 0; k < deltaX.size(); ++k)
-                {
-                    x[k] += deltaX[k];
-                }
+            TriangleBVH::RayHit hit;
+            if (collider.bvh.raycast(p, direction, earliest.t, hit) && glm::dot(hit.normal, direction) < 0.0f)
+            {
+                earliest = hit;
+                found = true;
             }
         }
+        if (!found) continue;
+
+        // keep the particle in front of the face it would have tunnelled through
+        float C_j = glm::dot(earliest.normal, x[vertex] - earliest.point);
+        if (C_j >= 0.0f) continue;
+
+        std::vector<glm::vec3> gradC_j = { earliest.normal };
+        std::array<unsigned int, 1> constraintVertices = { vertex };
+
+        float deltaLambda = calculateDeltaLambda(C_j, gradC_j, posDiff, constraintVertices, M, alphaTilde, gamma);
+        applyDeltaX(x, deltaLambda, M, gradC_j, constraintVertices);
     }
 }
 
-void Scene::applyPBD(
-    Object& object,
-    float deltaTime
+void Scene::beginDrag(const Object& object, unsigned int particle, const glm::vec3& target)
+{
+    if (object.isStatic() || particle >= object.getVertexTransforms().size()) return;
+    m_drag = DragConstraint{ &object, particle, target };
+}
+
+void Scene::moveDrag(const glm::vec3& target)
+{
+    if (m_drag) m_drag->target = target;
+}
+
+void Scene::solveDragConstraint(
+    std::vector<glm::vec3>& x,
+    const std::vector<glm::vec3>& posDiff,
+    const std::vector<float>& M,
+    float alphaTilde,
+    float gamma
 )
 {
-    const auto& mesh = object.getMesh();
-    const auto& distanceConstraints = mesh.distanceConstraints;
-    const auto& volumeConstraints = mesh.volumeConstraints;
-    const auto& perEnvCollisionConstraints = mesh.perEnvCollisionConstraints;
+    // zero-length spring between the particle and the target
+    unsigned int vertex = m_drag->particle;
+    if (vertex >= x.size()) return;
 
-    auto& vertexTransforms = object.getVertexTransforms();
-    const size_t numVerts = vertexTransforms.size();
+    glm::vec3 d = x[vertex] - m_drag->target;
+    float C_j = glm::length(d);
+    if (C_j < 1e-6f) return;
 
-    std::vector<float> M = object.getMass();
-    std::vector<glm::vec3> x(numVerts, glm::vec3(0.0f));
-    std::vector<glm::vec3> v(numVerts, glm::vec3(0.0f));
-    std::vector<glm::vec3> a(numVerts, glm::vec3(0.0f));
-    std::vector<glm::vec3> p(numVerts, glm::vec3(0.0f));
-    std::vector<glm::vec3> posDiff(numVerts, glm::vec3(0.0f));
-    std::vector<glm::vec3> deltaX(numVerts, glm::vec3(0.0f));
+    std::vector<glm::vec3> gradC_j = { d / C_j };
+    std::array<unsigned int, 1> constraintVertices = { vertex };
 
-    int subStep = 1;
+    float deltaLambda = calculateDeltaLambda(C_j, gradC_j, posDiff, constraintVertices, M, alphaTilde, gamma);
+    applyDeltaX(x, deltaLambda, M, gradC_j, constraintVertices);
+}
+
+void Scene::solveHeightfieldCollisions(
+    std::vector<glm::vec3>& x,
+    const std::vector<glm::vec3>& posDiff,
+    const std::vector<float>& M,
+    float alphaTilde,
+    float gamma
+)
+{
+    for (const auto& heightfield : m_heightfields)
+    {
+        for (size_t i = 0; i < x.size(); ++i)
+        {
+            glm::vec3 normal;
+            float depth;
+            if (!heightfield->findContact(x[i], normal, depth)) continue;
+
+            float C_j = -depth;
+            std::vector<glm::vec3> gradC_j = { normal };
+            std::array<unsigned int, 1> constraintVertices = { static_cast<unsigned int>(i) };
+
+            float deltaLambda = calculateDeltaLambda(C_j, gradC_j, posDiff, constraintVertices, M, alphaTilde, gamma);
+            applyDeltaX(x, deltaLambda, M, gradC_j, constraintVertices);
+        }
+    }
+}
+
+void Scene::solveSelfCollisions(
+    Object& object,
+    std::vector<glm::vec3>& x,
+    const std::vector<glm::vec3>& posDiff,
+    const std::vector<float>& M,
+    float alphaTilde,
+    float gamma
+)
+{
+    const Mesh& mesh = object.getMesh();
+    const auto& restPositions = mesh.getRestPositions();
+    float distance = object.getSelfCollisionDistance();
+    if (distance <= 0.0f) return;
+
+    m_selfCollisionHash.setSpacing(distance);
+    m_selfCollisionHash.build(x);
+    m_selfCollisionHash.findNeighbours(x, distance, m_selfCollisionOffsets, m_selfCollisionPairs);
+
+    for (unsigned int i = 0; i + 1 < m_selfCollisionOffsets.size(); ++i)
+    {
+        for (unsigned int k = m_selfCollisionOffsets[i]; k < m_selfCollisionOffsets[i + 1]; ++k)
+        {
+            unsigned int j = m_selfCollisionPairs[k];
+            if (mesh.areAdjacent(i, j)) continue;
+
+            // particles that start out closer only keep their rest distance
+            float minDistance = std::min(distance, glm::distance(restPositions[i], restPositions[j]));
+            glm::vec3 d = x[i] - x[j];
+            float length = glm::length(d);
+            if (length >= minDistance || length < 1e-6f) continue;
+
+            glm::vec3 n = d / length;
+            float C_j = length - minDistance;
+            std::vector<glm::vec3> gradC_j = { n, -n };
+            std::array<unsigned int, 2> constraintVertices = { i, j };
+
+            float deltaLambda = calculateDeltaLambda(C_j, gradC_j, posDiff, constraintVertices, M, alphaTilde, gamma);
+            applyDeltaX(x, deltaLambda, M, gradC_j, constraintVertices);
+        }
+    }
+
+    // vertices against the triangles around them, so a vertex cannot slip
+    // through a face between its particles; a triangle's own vertices and their
+    // edge neighbours are left out
+    const auto& triangles = mesh.volumeConstraints.triangles;
+    m_selfCollisionHash.buildTriangles(x, triangles, distance);
+    m_selfCollisionHash.findTriangleCandidates(x, m_selfCollisionTriangles);
+
+    for (unsigned int i = 0; i < m_selfCollisionTriangles.getNumRows(); ++i)
+    {
+        for (unsigned int t : m_selfCollisionTriangles[i])
+        {
+            const Triangle& tri = triangles[t];
+            if (tri.v1 == i || tri.v2 == i || tri.v3 == i) continue;
+            if (mesh.areAdjacent(i, tri.v1) || mesh.areAdjacent(i, tri.v2) || mesh.areAdjacent(i, tri.v3)) continue;
+
+            const glm::vec3& a = x[tri.v1];
+            const glm::vec3& b = x[tri.v2];
+            const glm::vec3& c = x[tri.v3];
+            glm::vec3 normal = glm::cross(b - a, c - a);
+            float area2 = glm::length(normal);
+            if (area2 < 1e-12f) continue;
+            normal /= area2;
+
+            float h = glm::dot(x[i] - a, normal);
+            if (std::abs(h) >= distance) continue;
+
+            // barycentric weights of the projection onto the plane, which has
+            // to land on the triangle
+            glm::vec3 q = x[i] - h * normal;
+            float wa = glm::dot(glm::cross(c - b, q - b), normal) / area2;
+            float wb = glm::dot(glm::cross(a - c, q - c), normal) / area2;
+            float wc = 1.0f - wa - wb;
+            if (wa < 0.0f || wb < 0.0f || wc < 0.0f) continue;
+
+            // the vertex is kept on the side it started the substep on
+            glm::vec3 a0 = a - posDiff[tri.v1];
+            glm::vec3 n0 = glm::cross(b - posDiff[tri.v2] - a0, c - posDiff[tri.v3] - a0);
+            float h0 = glm::dot(x[i] - posDiff[i] - a0, n0);
+            float side = (h0 != 0.0f ? h0 : h) < 0.0f ? -1.0f : 1.0f;
+
+            // vertices that start out closer to the plane only keep that distance
+            const glm::vec3& ra = restPositions[tri.v1];
+            glm::vec3 restNormal = glm::cross(restPositions[tri.v2] - ra, restPositions[tri.v3] - ra);
+            float restLength = glm::length(restNormal);
+            float thickness = distance;
+            if (restLength > 1e-12f)
+            {
+                thickness = std::min(distance, std::abs(glm::dot(restPositions[i] - ra, restNormal)) / restLength);
+            }
+
+            float C_j = side * h - thickness;
+            if (C_j >= 0.0f) continue;
+
+            glm::vec3 n = side * normal;
+            std::vector<glm::vec3> gradC_j = { n, -wa * n, -wb * n, -wc * n };
+            std::array<unsigned int, 4> constraintVertices = { i, tri.v1, tri.v2, tri.v3 };
+
+            float deltaLambda = calculateDeltaLambda(C_j, gradC_j, posDiff, constraintVertices, M, alphaTilde, gamma);
+            applyDeltaX(x, deltaLambda, M, gradC_j, constraintVertices);
+        }
+    }
+}
+
+std::shared_ptr<const SignedDistanceField> Scene::getSignedDistanceField(
+    const std::vector<glm::vec3>& localPositions,
+    const std::vector<Triangle>& triangles,
+    const glm::vec3& scale
+)
+{
+    static constexpr float voxelsPerExtent = 128.0f;
+
+    // the collider's frame only removes rotation and translation, so posed
+    // copies of one mesh at one scale bake and look up the same field
+    std::vector<glm::vec3> positions(localPositions.size());
+    for (size_t i = 0; i < localPositions.size(); ++i)
+    {
+        positions[i] = localPositions[i] * scale;
+    }
+
+    // the triangles' bounds, as the BVH root would have them; the BVH itself
+    // is only built when the field has to be baked
+    glm::vec3 min(std::numeric_limits<float>::max());
+    glm::vec3 max(-std::numeric_limits<float>::max());
+    for (const Triangle& tri : triangles)
+    {
+        for (unsigned int v : { tri.v1, tri.v2, tri.v3 })
+        {
+            min = glm::min(min, positions[v]);
+            max = glm::max(max, positions[v]);
+        }
+    }
+    glm::vec3 extent = max - min;
+    float voxelSize = std::max({ extent.x, extent.y, extent.z }) / voxelsPerExtent;
+    if (!(voxelSize > 0.0f)) return nullptr;
+
+    uint64_t key = SignedDistanceField::calculateKey(localPositions, triangles, scale, voxelSize);
+    auto it = m_signedDistanceFields.find(key);
+    if (it != m_signedDistanceFields.end()) return it->second;
+
+    std::ostringstream path;
+    path << "../res/cache/sdf/" << std::hex << key << ".sdf";
+
+    // workers load what the coordinator bakes rather than bake it once each;
+    // if the coordinator couldn't write the file they bake it themselves
+    bool isWorker = m_workerPool && !m_workerPool->isCoordinator();
+    uint32_t field = m_numFieldLookups++;
+    if (isWorker)
+    {
+        m_workerPool->waitForField(field);
+    }
+
+    auto sdf = std::make_shared<SignedDistanceField>();
+    if (!sdf->load(path.str(), key))
+    {
+        TriangleBVH bvh(positions, triangles);
+        sdf->bake(bvh, voxelSize);
+
+        std::error_code error;
+        std::filesystem::create_directories(std::filesystem::path(path.str()).parent_path(), error);
+        if (!isWorker)
+        {
+            sdf->save(path.str(), key);
+        }
+        std::cout << "SignedDistanceField baked: " << sdf->getNumAllocatedBricks() << "/"
+                  << sdf->getNumBricks() << " bricks -> " << path.str() << std::endl;
+    }
+
+    if (m_workerPool && !isWorker)
+    {
+        m_workerPool->publishField();
+    }
+
+    m_signedDistanceFields.emplace(key, sdf);
+    return sdf;
+}
+
+void Scene::updateKinematicColliders()
+{
+    size_t collider = 0;
+    for (const auto& obj : m_objects)
+    {
+        if (!obj->isStatic()) continue;
+        if (collider >= m_staticColliders.size()) return;
+
+        StaticCollider& staticCollider = m_staticColliders[collider++];
+        if (!staticCollider.isKinematic) continue;
+
+        obj->updateKinematicPose(m_time);
+        staticCollider.previousPose = staticCollider.pose;
+        staticCollider.pose = obj->getKinematicPose();
+
+        if (staticCollider.proxy >= 0)
+        {
+            glm::vec3 min = staticCollider.bvh.getMin();
+            glm::vec3 max = staticCollider.bvh.getMax();
+            transformBounds(staticCollider.pose, min, max);
+            m_staticColliderTree.moveProxy(staticCollider.proxy, min, max);
+        }
+    }
+}
+
+bool Scene::haveStaticCollidersChanged() const
+{
+    size_t collider = 0;
+    for (const auto& obj : m_objects)
+    {
+        if (!obj->isStatic()) continue;
+        if (collider >= m_staticColliders.size()) return true;
+        const StaticCollider& staticCollider = m_staticColliders[collider++];
+        if (obj->getTransform().getModelMatrix() != staticCollider.model) return true;
+        if (obj->isKinematic() != staticCollider.isKinematic) return true;
+        if (obj->getColliderShape() != staticCollider.shape) return true;
+    }
+    return collider != m_staticColliders.size();
+}
+
+void Scene::buildInstanceBatches()
+{
+    // group non-static objects by source mesh, then split groups on topology
+    std::vector<std::vector<Object*>> groups;
+    for (const auto& obj : m_objects)
+    {
+        if (obj->isStatic()) continue;
+
+        bool added = false;
+        for (auto& group : groups)
+        {
+            const Mesh& first = group.front()->getMesh();
+            if (first.getMeshPath() == obj->getMesh().getMeshPath() &&
+                InstanceBatch::haveSameTopology(first, obj->getMesh()))
+            {
+                group.push_back(obj.get());
+                added = true;
+                break;
+            }
+        }
+
+        if (!added)
+        {
+            groups.push_back({ obj.get() });
+        }
+    }
+
+    // a batch of one gains nothing over the regular path
+    for (const auto& group : groups)
+    {
+        if (group.size() < 2) continue;
+
+        m_instanceBatches.push_back(std::make_unique<InstanceBatch>(group, m_k));
+        m_batchedObjects.insert(group.begin(), group.end());
+    }
+}
+
+void Scene::removeFromInstanceBatch(const Object& object)
+{
+    // a torn instance no longer shares its batch's topology; only its own lane
+    // goes, the other batches are left alone
+    for (auto it = m_instanceBatches.begin(); it != m_instanceBatches.end(); ++it)
+    {
+        InstanceBatch& batch = **it;
+        if (!batch.removeInstance(&object)) continue;
+        m_batchedObjects.erase(&object);
+
+        // a batch of one gains nothing over the regular path
+        if (batch.getNumLanes() < 2)
+        {
+            for (const Object* instance : batch.getInstances())
+            {
+                m_batchedObjects.erase(instance);
+            }
+            m_instanceBatches.erase(it);
+        }
+        return;
+    }
+}
+
+void Scene::setupMeshPartitions()
+{
+    // one domain per thread, but never domains so small that the boundary
+    // phase dominates
+    const int maxThreads = omp_get_max_threads();
+    for (const auto& obj : m_objects)
+    {
+        if (obj->isStatic()) continue;
+
+        Mesh& mesh = obj->getMesh();
+        int numParts = std::min<int>(maxThreads, static_cast<int>(mesh.getNumPositions() / m_minVerticesPerDomain));
+        if (numParts < 2) continue;
+
+        mesh.partitionConstraintGraph(numParts);
+        mesh.partition.print(obj->getName());
+    }
+}
+
+Scene::Scene(
+    const std::string& name,
+    std::unique_ptr<ShaderManager> shaderManager,
+    std::unique_ptr<MeshManager> meshManager,
+    std::unique_ptr<TextureManager> textureManager,
+    std::unique_ptr<Camera> camera,
+    int numWorkerProcesses
+)
+    :   m_name(name),
+        m_shaderManager(std::move(shaderManager)),
+        m_meshManager(std::move(meshManager)),
+        m_textureManager(std::move(textureManager)),
+        m_camera(std::move(camera)),
+        m_envCollisionGrid(2.0f),
+        m_softBodyTree(0.2f),
+        m_gravitationalAcceleration(0.0f),
+        m_pbdSubsteps(10),
+        m_time(0.0f),
+        m_enableDistanceConstraints(true),
+        m_enableBendingConstraints(true),
+        m_enableVolumeConstraints(true),
+        m_enableEnvCollisionConstraints(true),
+        m_enableEnvCollisionGrid(true),
+        m_enableColliderBVH(true),
+        m_enableColliderSDF(true),
+        m_enableAnalyticColliders(true),
+        m_enableConvexHullColliders(true),
+        m_enableSoftBodyCollisions(true),
+        m_enableContinuousCollisions(true),
+        m_enableContactReuse(true),
+        m_enableContactVelocities(true),
+        m_enableInstanceBatching(true),
+        m_enablePartitionedSolve(true),
+        m_enableTearing(false),
+        m_enableFluids(true),
+        m_enableCloth(true),
+        m_minVerticesPerDomain(512),
+        m_alpha(0.001f),
+        m_beta(5.0f),
+        m_bendingAlpha(0.01f),
+        m_k(1.0f),
+        m_tearStrain(0.5f),
+        m_continuousCollisionThreshold(0.2f),
+        m_contactMargin(0.05f),
+        m_friction(0.5f),
+        m_restitution(0.2f),
+        m_dragAlpha(0.0001f),
+        m_maxTearsPerFrame(8)
+{
+    createObjects();
+    setupEnvCollisionConstraints();
+
+    // forked children don't get the parent's OpenMP threads, so workers are
+    // launched before the first parallel region and set up their own copy
+    if (numWorkerProcesses > 0)
+    {
+        launchWorkerProcesses(numWorkerProcesses);
+    }
+    setupSimulation();
+
+    std::cout << name << " created.\n";
+}
+
+void Scene::setupSimulation()
+{
+    buildStaticColliders();
+    buildSoftBodyColliders();
+    buildInstanceBatches();
+    setupMeshPartitions();
+}
+
+void Scene::applyGravity(
+    Object& object,
+    float deltaTime
+)
+{
+    for (auto& vertexTransform : object.getVertexTransforms())
+    {
+        vertexTransform.setAcceleration(m_gravitationalAcceleration);
+    }
+}
+
+float Scene::calculateDeltaLambda(
+    float C_j,
+    const std::vector<glm::vec3>& gradC_j,
+    const std::vector<glm::vec3>& posDiff,
+    std::span<const unsigned int> constraintVertices,
+    const std::vector<float>& M,
+    float alphaTilde,
+    float gamma
+)
+{
+    float gradCMInverseGradCT = 0.0f;
+    float gradCPosDiff = 0.0f;
+    size_t n = constraintVertices.size();
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        unsigned int v = constraintVertices[i];
+        float w = 1.0f / M[v];
+        gradCMInverseGradCT += w * glm::dot(gradC_j[i], gradC_j[i]);
+        gradCPosDiff += glm::dot(gradC_j[i], posDiff[v]);
+    }
+
+    return (-C_j - gamma * gradCPosDiff) / ((1 + gamma) * gradCMInverseGradCT + alphaTilde);
+}
+
+void Scene::applyDeltaX(
+    std::vector<glm::vec3>& x,
+    float lambda,
+    const std::vector<float>& M,
+    const std::vector<glm::vec3>& gradC_j,
+    std::span<const unsigned int> constraintVertices
+)
+{
+    // only the constraint's own vertices move, so update them in place
+    size_t n = constraintVertices.size();
+    for (size_t i = 0; i < n; ++i)
+    {
+        unsigned int v = constraintVertices[i];
+        float w = 1.0f / M[v];
+        x[v] += lambda * w * gradC_j[i];
+    }
+}
+
+void Scene::solveDistanceConstraints(
+    std::vector<glm::vec3>& x,
+    const std::vector<glm::vec3>& posDiff,
+    const std::vector<float>& M,
+    float alphaTilde,
+    float gamma,
+    const Mesh::DistanceConstraints& distanceConstraints
+)
+{
+    size_t edgesSize = distanceConstraints.edges.size();
+    size_t CSize = distanceConstraints.C.size();
+    size_t gradCSize = distanceConstraints.gradC.size();
+    if (edgesSize != gradCSize)
+    {
+        std::cerr << "DistanceConstraints size mismatch:\n"
+                  << "constraints = " << CSize << ", "
+                  << "gradConstraints = " << gradCSize << ", "
+                  << "edgeVertices = " << edgesSize << std::endl;
+        return;
+    }
+
+    for (size_t j = 0; j < distanceConstraints.edges.size(); ++j)
+    {
+        solveDistanceConstraint(j, x, posDiff, M, alphaTilde, gamma, distanceConstraints);
+    }
+}
+
+void Scene::solveDistanceConstraint(
+    size_t j,
+    std::vector<glm::vec3>& x,
+    const std::vector<glm::vec3>& posDiff,
+    const std::vector<float>& M,
+    float alphaTilde,
+    float gamma,
+    const Mesh::DistanceConstraints& distanceConstraints
+)
+{
+    float C_j = distanceConstraints.C[j](x);
+    std::vector<glm::vec3> gradC_j = distanceConstraints.gradC[j](x);
+    const Edge& edge = distanceConstraints.edges[j];
+    const std::array<unsigned int, 2> constraintVertices = { edge.v1, edge.v2 };
+
+    float deltaLambda = calculateDeltaLambda(C_j, gradC_j, posDiff, constraintVertices, M, alphaTilde, gamma);
+    applyDeltaX(x, deltaLambda, M, gradC_j, constraintVertices);
+}
+
+void Scene::solveDistanceConstraintsPartitioned(
+    std::vector<glm::vec3>& x,
+    const std::vector<glm::vec3>& posDiff,
+    const std::vector<float>& M,
+    float alphaTilde,
+    float gamma,
+    const Mesh::DistanceConstraints& distanceConstraints,
+    const MeshPartition& partition
+)
+{
+    // interior constraints only touch their own domain's vertices, so every
+    // domain is solved on its own thread
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (int part = 0; part < partition.numParts; ++part)
+    {
+        for (unsigned int j : partition.interiorConstraints[part])
+        {
+            solveDistanceConstraint(j, x, posDiff, M, alphaTilde, gamma, distanceConstraints);
+        }
+    }
+
+    // constraints crossing domains afterwards, serially
+    for (unsigned int j : partition.boundaryConstraints)
+    {
+        solveDistanceConstraint(j, x, posDiff, M, alphaTilde, gamma, distanceConstraints);
+    }
+}
+
+void Scene::solveBendingConstraints(
+    std::vector<glm::vec3>& x,
+    const std::vector<glm::vec3>& posDiff,
+    const std::vector<float>& M,
+    float alphaTilde,
+    float gamma,
+    const Mesh::BendingConstraints& bendingConstraints
+)
+{
+    size_t stencilsSize = bendingConstraints.stencils.size();
+    size_t CSize = bendingConstraints.C.size();
+    size_t gradCSize = bendingConstraints.gradC.size();
+    if (stencilsSize != gradCSize || stencilsSize != CSize)
+    {
+        std::cerr << "BendingConstraints size mismatch:\n"
+                  << "constraints = " << CSize << ", "
+                  << "gradConstraints = " << gradCSize << ", "
+                  << "stencils = " << stencilsSize << std::endl;
+        return;
+    }
+
+    for (size_t j = 0; j < stencilsSize; ++j)
+    {
+        float C_j = bendingConstraints.C[j](x);
+        std::vector<glm::vec3> gradC_j = bendingConstraints.gradC[j](x);
+        const BendingStencil& stencil = bendingConstraints.stencils[j];
+        const std::array<unsigned int, 4> constraintVertices = { stencil.v1, stencil.v2, stencil.v3, stencil.v4 };
+
+        float deltaLambda = calculateDeltaLambda(C_j, gradC_j, posDiff, constraintVertices, M, alphaTilde, gamma);
+        applyDeltaX(x, deltaLambda, M, gradC_j, constraintVertices);
+    }
+}
+
+void Scene::solveVolumeConstraints(
+    std::vector<glm::vec3>& x,
+    const std::vector<glm::vec3>& posDiff,
+    const std::vector<float>& M,
+    float alphaTilde,
+    float gamma,
+    const Mesh::VolumeConstraints& volumeConstraints
+)
+{
+    size_t trianglesSize = volumeConstraints.triangles.size();
+    size_t CSize = volumeConstraints.C.size();
+    size_t gradCSize = volumeConstraints.gradC.size();
+    if (trianglesSize != gradCSize)
+    {
+        std::cerr << "VolumeConstraints size mismatch:\n"
+                  << "constraints = " << CSize << ", "
+                  << "gradConstraints = " << gradCSize << ", "
+                  << "triangleVertices = " << trianglesSize << std::endl;
+        return;
+    }
+
+    for (size_t j = 0; j < volumeConstraints.triangles.size(); ++j)
+    {
+        float C_j = volumeConstraints.C[0](x);
+        std::vector<glm::vec3> gradC_j = volumeConstraints.gradC[j](x);
+        const Triangle& tri = volumeConstraints.triangles[j];
+        const std::array<unsigned int, 3> constraintVertices = { tri.v1, tri.v2, tri.v3 };
+
+        float deltaLambda = calculateDeltaLambda(C_j, gradC_j, posDiff, constraintVertices, M, alphaTilde, gamma);
+        applyDeltaX(x, deltaLambda, M, gradC_j, constraintVertices);
+    }
+}
+
+void Scene::solveEnvCollisionConstraints(
+    std::vector<glm::vec3>& x,
+    const std::vector<glm::vec3>& posDiff,
+    const std::vector<float>& M,
+    float alphaTilde,
+    float gamma,
+    std::vector<Mesh::EnvCollisionConstraints>& perEnvCollisionConstraints
+)
+{
+    // static colliders with a triangle near each particle's swept box
+    const bool useGrid = m_enableEnvCollisionGrid && !m_envCollisionGrid.empty();
+    Adjacency nearColliders;
+    if (useGrid)
+    {
+        nearColliders.gather(x.size(), [&](size_t i, std::vector<unsigned int>& out) {
+            // query results are reused by every row a thread gathers
+            static thread_local std::vector<SpatialHash::Entry> hits;
+            glm::vec3 p = x[i] - posDiff[i];
+            m_envCollisionGrid.query(glm::min(p, x[i]), glm::max(p, x[i]), hits);
+
+            size_t start = out.size();
+            for (const auto& hit : hits)
+            {
+                if (out.size() == start || out.back() != hit.collider)
+                {
+                    out.push_back(hit.collider);
+                }
+            }
+        });
+    }
+
+    std::vector<float> depths;
+    std::vector<glm::vec3> normals;
+    std::vector<glm::vec3> restX;
+    for (size_t setIdx = 0; setIdx < perEnvCollisionConstraints.size(); ++setIdx)
+    {
+        auto& constraints = perEnvCollisionConstraints[setIdx];
+        if (constraints.vertices.size() != constraints.lastPlanes.size())
+        {
+            std::cerr << "EnvCollisionConstraints size mismatch in set " << setIdx << std::endl;
+            continue;
+        }
+
+        // other soft bodies move every substep and are not static colliders
+        int collider = m_envCollisionGrid.getColliderIndex(constraints.candidateMesh);
+        const StaticCollider* staticCollider = collider >= 0 ? &m_staticColliders[collider] : nullptr;
+        if (!staticCollider && m_enableSoftBodyCollisions) continue;
+
+        // kinematic colliders are tested against their cached geometry with the
+        // particles carried into its rest frame; corrections are rotated back
+        const bool isKinematic = staticCollider && staticCollider->isKinematic;
+        glm::mat3 poseRotation(1.0f);
+        if (isKinematic)
+        {
+            poseRotation = glm::mat3(staticCollider->pose);
+            restX.resize(x.size());
+            for (unsigned int vertex : constraints.vertices)
+            {
+                restX[vertex] = toRestFrame(staticCollider->pose, x[vertex]);
+            }
+        }
+        const std::vector<glm::vec3>& queryX = isKinematic ? restX : x;
+
+        // analytic shapes test every particle in one pass
+        if (staticCollider && staticCollider->shape && m_enableAnalyticColliders)
+        {
+            staticCollider->shape->findContacts(queryX, depths, normals);
+            for (unsigned int vertex : constraints.vertices)
+            {
+                if (depths[vertex] <= 0.0f) continue;
+
+                float C_j = -depths[vertex];
+                std::vector<glm::vec3> gradC_j = { poseRotation * normals[vertex] };
+                std::array<unsigned int, 1> constraintVertices = { vertex };
+
+                float deltaLambda = calculateDeltaLambda(C_j, gradC_j, posDiff, constraintVertices, M, alphaTilde, gamma);
+                applyDeltaX(x, deltaLambda, M, gradC_j, constraintVertices);
+            }
+            continue;
+        }
+
+        const Mesh::CollisionPlanes& planes = constraints.candidateMesh->getCollisionPlanes();
+        for (size_t k = 0; k < constraints.vertices.size(); ++k)
+        {
+            unsigned int vertex = constraints.vertices[k];
+            // a swept box clear of every face is either outside the collider
+            // or wholly inside it, so it is only skipped outside its bounds
+            if (collider >= 0 && useGrid && !isKinematic)
+            {
+                const auto& near = nearColliders[vertex];
+                if (std::find(near.begin(), near.end(), static_cast<unsigned int>(collider)) == near.end())
+                {
+                    const TriangleBVH& bvh = staticCollider->bvh;
+                    glm::vec3 p = x[vertex] - posDiff[vertex];
+                    glm::vec3 sweptMin = glm::min(p, x[vertex]);
+                    glm::vec3 sweptMax = glm::max(p, x[vertex]);
+                    if (bvh.empty() ||
+                        glm::any(glm::lessThan(sweptMax, bvh.getMin())) ||
+                        glm::any(glm::greaterThan(sweptMin, bvh.getMax())))
+                    {
+                        continue;
+                    }
+                }
+            }
+
+            if (staticCollider && staticCollider->hull && m_enableConvexHullColliders)
+            {
+                glm::vec3 normal;
+                float depth;
+                if (!staticCollider->hull->findContact(queryX[vertex], normal, depth)) continue;
+
+                float C_j = -depth;
+                std::vector<glm::vec3> gradC_j = { poseRotation * normal };
+                std::array<unsigned int, 1> constraintVertices = { vertex };
+
+                float deltaLambda = calculateDeltaLambda(C_j, gradC_j, posDiff, constraintVertices, M, alphaTilde, gamma);
+                applyDeltaX(x, deltaLambda, M, gradC_j, constraintVertices);
+                continue;
+            }
+
+            // static colliders: depth and normal from the signed distance, either
+            // looked up in the baked field or from the closest point on the surface
+            if (staticCollider && m_enableColliderSDF && staticCollider->sdf)
+            {
+                glm::vec3 gradient;
+                glm::vec3 p = glm::transpose(staticCollider->rotation) * (queryX[vertex] - staticCollider->translation);
+                float distance = staticCollider->sdf->sample(p, gradient);
+                float length = glm::length(gradient);
+                if (distance >= 0.0f || length < 1e-6f) continue;
+
+                float C_j = distance;
+                std::vector<glm::vec3> gradC_j = { poseRotation * staticCollider->rotation * (gradient / length) };
+                std::array<unsigned int, 1> constraintVertices = { vertex };
+
+                float deltaLambda = calculateDeltaLambda(C_j, gradC_j, posDiff, constraintVertices, M, alphaTilde, gamma);
+                applyDeltaX(x, deltaLambda, M, gradC_j, constraintVertices);
+                continue;
+            }
+
+            if (staticCollider && m_enableColliderBVH)
+            {
+                glm::vec3 normal;
+                float depth;
+                if (!staticCollider->bvh.findContact(queryX[vertex], normal, depth)) continue;
+
+                float C_j = -depth;
+                std::vector<glm::vec3> gradC_j = { poseRotation * normal };
+                std::array<unsigned int, 1> constraintVertices = { vertex };
+
+                float deltaLambda = calculateDeltaLambda(C_j, gradC_j, posDiff, constraintVertices, M, alphaTilde, gamma);
+                applyDeltaX(x, deltaLambda, M, gradC_j, constraintVertices);
+                continue;
+            }
+
+            // the plane the vertex was last in front of usually still
+            // separates it, so most vertices cost a single dot product
+            unsigned int& lastPlane = constraints.lastPlanes[k];
+            const size_t numPlanes = planes.normals.size();
+            if (lastPlane < numPlanes &&
+                glm::dot(planes.normals[lastPlane], queryX[vertex]) - planes.offsets[lastPlane] >= 0.0f)
+            {
+                continue;
+            }
+
+            // behind every plane means a collision, resolved through the
+            // plane with the smallest penetration
+            bool allNegative = true;
+            float maxNegativeC = -std::numeric_limits<float>::max();
+            size_t maxIdx = 0;
+            for (size_t idx = 0; idx < numPlanes; ++idx)
+            {
+                float C_j = glm::dot(planes.normals[idx], queryX[vertex]) - planes.offsets[idx];
+                if (C_j >= 0.0f)
+                {
+                    allNegative = false;
+                    lastPlane = static_cast<unsigned int>(idx);
+                    break;
+                }
+
+                if (C_j > maxNegativeC)
+                {
+                    maxNegativeC = C_j;
+                    maxIdx = idx;
+                }
+            }
+
+            if (allNegative && numPlanes > 0)
+            {
+                lastPlane = static_cast<unsigned int>(maxIdx);
+
+                float C_j = maxNegativeC;
+                std::vector<glm::vec3> gradC_j = { poseRotation * planes.normals[maxIdx] };
+                std::array<unsigned int, 1> constraintVertices = { vertex };
+
+                float deltaLambda = calculateDeltaLambda(C_j, gradC_j, posDiff, constraintVertices, M, alphaTilde, gamma);
+                applyDeltaX(x, deltaLambda, M, gradC_j, constraintVertices);
+            }
+        }
+    }
+}
+
+void Scene::applyPBD(
+    Object& object,
+    float deltaTime
+)
+{
+    auto& mesh = object.getMesh();
+    const auto& distanceConstraints = mesh.distanceConstraints;
+    const auto& volumeConstraints = mesh.volumeConstraints;
+    auto& perEnvCollisionConstraints = mesh.perEnvCollisionConstraints;
+
+    auto& vertexTransforms = object.getVertexTransforms();
+    const size_t numVerts = vertexTransforms.size();
+
+    std::vector<float> M = object.getMass();
+    std::vector<glm::vec3> x(numVerts, glm::vec3(0.0f));
+    std::vector<glm::vec3> v(numVerts, glm::vec3(0.0f));
+    std::vector<glm::vec3> a(numVerts, glm::vec3(0.0f));
+    std::vector<glm::vec3> p(numVerts, glm::vec3(0.0f));
+    std::vector<glm::vec3> posDiff(numVerts, glm::vec3(0.0f));
+
+    int subStep = 1;
     const int n = m_pbdSubsteps;
     float deltaTime_s = deltaTime / static_cast<float>(n);
 
@@ -425,6 +1662,12 @@ void Scene::applyPBD(
     float betaTilde;
     float gamma;
 
+    std::vector<Contact> contacts;
+    if (m_enableEnvCollisionConstraints && m_enableContactReuse)
+    {
+        gatherContacts(object, deltaTime, contacts);
+    }
+
     while (subStep < n + 1)
     {
         for (size_t i = 0; i < numVerts; ++i)
@@ -443,29 +1686,90 @@ void Scene::applyPBD(
             alphaTilde = 0.0f;
             betaTilde = 0.0f;
             gamma = 0.0f;
-            solveEnvCollisionConstraints(
-                x,
-                posDiff,
-                M,
-                alphaTilde,
-                gamma,
-                perEnvCollisionConstraints
-            );
+            if (m_enableContactReuse)
+            {
+                solveContacts(x, posDiff, M, alphaTilde, gamma, contacts, subStep * deltaTime_s);
+
+                // the planes only cover colliders near the start of the frame
+                if (m_enableContinuousCollisions)
+                {
+                    solveContinuousCollisions(x, posDiff, M, alphaTilde, gamma);
+                }
+            }
+            else
+            {
+                if (m_enableContinuousCollisions)
+                {
+                    solveContinuousCollisions(x, posDiff, M, alphaTilde, gamma);
+                }
+
+                solveEnvCollisionConstraints(
+                    x,
+                    posDiff,
+                    M,
+                    alphaTilde,
+                    gamma,
+                    perEnvCollisionConstraints
+                );
+                solveHeightfieldCollisions(x, posDiff, M, alphaTilde, gamma);
+            }
+
+            if (m_enableSoftBodyCollisions)
+            {
+                solveSoftBodyCollisions(object, x, posDiff, M, alphaTilde, gamma);
+            }
+        }
+
+        // Self collision
+        if (object.enableSelfCollision())
+        {
+            solveSelfCollisions(object, x, posDiff, M, 0.0f, 0.0f);
+        }
+
+        // Distance constraints
+        if (m_enableDistanceConstraints)
+        {
+            alphaTilde = m_alpha / (deltaTime_s * deltaTime_s);
+            betaTilde = (deltaTime_s * deltaTime_s) * m_beta;
+            gamma = (alphaTilde * betaTilde) / deltaTime_s;
+            if (m_enablePartitionedSolve && !mesh.partition.empty())
+            {
+                solveDistanceConstraintsPartitioned(
+                    x,
+                    posDiff,
+                    M,
+                    alphaTilde,
+                    gamma,
+                    distanceConstraints,
+                    mesh.partition
+                );
+            }
+            else
+            {
+                solveDistanceConstraints(
+                    x,
+                    posDiff,
+                    M,
+                    alphaTilde,
+                    gamma,
+                    distanceConstraints
+                );
+            }
         }
 
-        // Distance constraints
-        if (m_enableDistanceConstraints)
+        // Bending constraints
+        if (m_enableBendingConstraints)
         {
-            alphaTilde = m_alpha / (deltaTime_s * deltaTime_s);
+            alphaTilde = m_bendingAlpha / (deltaTime_s * deltaTime_s);
             betaTilde = (deltaTime_s * deltaTime_s) * m_beta;
             gamma = (alphaTilde * betaTilde) / deltaTime_s;
-            solveDistanceConstraints(
+            solveBendingConstraints(
                 x,
                 posDiff,
                 M,
                 alphaTilde,
                 gamma,
-                distanceConstraints
+                mesh.bendingConstraints
             );
         }
 
@@ -485,40 +1789,590 @@ void Scene::applyPBD(
             );
         }
 
+        // Drag constraint
+        if (m_drag && m_drag->object == &object)
+        {
+            alphaTilde = m_dragAlpha / (deltaTime_s * deltaTime_s);
+            solveDragConstraint(x, posDiff, M, alphaTilde, 0.0f);
+        }
+
+        // Update velocities
+        for (size_t i = 0; i < numVerts; ++i)
+        {
+            v[i] = (x[i] - p[i]) / deltaTime_s;
+        }
+
+        // Friction and restitution
+        if (m_enableEnvCollisionConstraints && m_enableContactReuse && m_enableContactVelocities)
+        {
+            solveContactVelocities(v, posDiff, contacts, deltaTime_s);
+        }
+
         // Update positions and velocities
         for (size_t i = 0; i < numVerts; ++i)
         {
-            Transform& vertexTransform = vertexTransforms[i];
+            vertexTransforms[i].setPosition(x[i]);
+            vertexTransforms[i].setVelocity(v[i]);
+        }
+
+        subStep++;
+    }
+}
+
+void Scene::applyBatchedPBD(
+    InstanceBatch& batch,
+    float deltaTime
+)
+{
+    const auto& instances = batch.getInstances();
+    std::vector<glm::vec3> x;
+    std::vector<glm::vec3> v;
+    std::vector<glm::vec3> posDiff;
+
+    int subStep = 1;
+    const int n = m_pbdSubsteps;
+    float deltaTime_s = deltaTime / static_cast<float>(n);
+
+    float alphaTilde;
+    float betaTilde;
+    float gamma;
+
+    std::vector<std::vector<Contact>> contacts(instances.size());
+    if (m_enableEnvCollisionConstraints && m_enableContactReuse)
+    {
+        for (size_t lane = 0; lane < instances.size(); ++lane)
+        {
+            gatherContacts(*instances[lane], deltaTime, contacts[lane]);
+        }
+    }
+
+    batch.loadVertexTransforms();
+
+    while (subStep < n + 1)
+    {
+        batch.predict(deltaTime_s);
+
+        // Environment Collision constraints (per instance, positions differ)
+        if (m_enableEnvCollisionConstraints)
+        {
+            for (size_t lane = 0; lane < instances.size(); ++lane)
+            {
+                Object& object = *instances[lane];
+                batch.gatherInstance(lane, x, posDiff);
+                if (m_enableContactReuse)
+                {
+                    solveContacts(x, posDiff, object.getMass(), 0.0f, 0.0f, contacts[lane], subStep * deltaTime_s);
+                    if (m_enableContinuousCollisions)
+                    {
+                        solveContinuousCollisions(x, posDiff, object.getMass(), 0.0f, 0.0f);
+                    }
+                }
+                else
+                {
+                    if (m_enableContinuousCollisions)
+                    {
+                        solveContinuousCollisions(x, posDiff, object.getMass(), 0.0f, 0.0f);
+                    }
+                    solveEnvCollisionConstraints(
+                        x,
+                        posDiff,
+                        object.getMass(),
+                        0.0f,
+                        0.0f,
+                        object.getMesh().perEnvCollisionConstraints
+                    );
+                    solveHeightfieldCollisions(x, posDiff, object.getMass(), 0.0f, 0.0f);
+                }
+                if (m_enableSoftBodyCollisions)
+                {
+                    solveSoftBodyCollisions(object, x, posDiff, object.getMass(), 0.0f, 0.0f);
+                }
+                batch.scatterInstance(lane, x);
+            }
+        }
+
+        // Self collision
+        for (size_t lane = 0; lane < instances.size(); ++lane)
+        {
+            Object& object = *instances[lane];
+            if (!object.enableSelfCollision()) continue;
+
+            batch.gatherInstance(lane, x, posDiff);
+            solveSelfCollisions(object, x, posDiff, object.getMass(), 0.0f, 0.0f);
+            batch.scatterInstance(lane, x);
+        }
+
+        alphaTilde = m_alpha / (deltaTime_s * deltaTime_s);
+        betaTilde = (deltaTime_s * deltaTime_s) * m_beta;
+        gamma = (alphaTilde * betaTilde) / deltaTime_s;
+
+        // Distance constraints
+        if (m_enableDistanceConstraints)
+        {
+            batch.solveDistanceConstraints(alphaTilde, gamma);
+        }
+
+        // Bending constraints
+        if (m_enableBendingConstraints)
+        {
+            float bendingAlphaTilde = m_bendingAlpha / (deltaTime_s * deltaTime_s);
+            float bendingGamma = (bendingAlphaTilde * betaTilde) / deltaTime_s;
+            batch.solveBendingConstraints(bendingAlphaTilde, bendingGamma);
+        }
+
+        // Volume constraints
+        if (m_enableVolumeConstraints)
+        {
+            batch.solveVolumeConstraints(alphaTilde, gamma);
+        }
+
+        // Drag constraint
+        for (size_t lane = 0; m_drag && lane < instances.size(); ++lane)
+        {
+            Object& object = *instances[lane];
+            if (m_drag->object != &object) continue;
+
+            batch.gatherInstance(lane, x, posDiff);
+            solveDragConstraint(x, posDiff, object.getMass(), m_dragAlpha / (deltaTime_s * deltaTime_s), 0.0f);
+            batch.scatterInstance(lane, x);
+        }
+
+        batch.updateVelocities(deltaTime_s);
+
+        // Friction and restitution
+        if (m_enableEnvCollisionConstraints && m_enableContactReuse && m_enableContactVelocities)
+        {
+            for (size_t lane = 0; lane < instances.size(); ++lane)
+            {
+                if (contacts[lane].empty()) continue;
+
+                batch.gatherInstance(lane, x, posDiff);
+                batch.gatherVelocities(lane, v);
+                solveContactVelocities(v, posDiff, contacts[lane], deltaTime_s);
+                batch.scatterVelocities(lane, v);
+            }
+        }
+
+        subStep++;
+    }
+
+    batch.storeVertexTransforms();
+}
+
+void Scene::applyFluidPBD(
+    FluidSystem& fluid,
+    float deltaTime
+)
+{
+    int subStep = 1;
+    const int n = m_pbdSubsteps;
+    float deltaTime_s = deltaTime / static_cast<float>(n);
+
+    while (subStep < n + 1)
+    {
+        fluid.predict(deltaTime_s, m_gravitationalAcceleration);
+
+        // particles move far enough between substeps to change neighbours
+        fluid.findNeighbours();
+
+        for (int iteration = 0; iteration < fluid.getSolverIterations(); ++iteration)
+        {
+            fluid.solveDensityConstraints();
+            solveParticleCollisions(fluid.getPredictedPositions(), fluid.getParticleRadius());
+        }
+
+        fluid.updateVelocities(deltaTime_s);
+
+        subStep++;
+    }
+}
+
+void Scene::applyClothPBD(
+    Cloth& cloth,
+    float deltaTime
+)
+{
+    int subStep = 1;
+    const int n = m_pbdSubsteps;
+    float deltaTime_s = deltaTime / static_cast<float>(n);
+
+    while (subStep < n + 1)
+    {
+        cloth.predict(deltaTime_s, m_gravitationalAcceleration);
 
-            glm::vec3 newX = x[i];
-            glm::vec3 newV = (newX - p[i]) / deltaTime_s;
+        for (int iteration = 0; iteration < cloth.getSolverIterations(); ++iteration)
+        {
+            cloth.solveConstraints(deltaTime_s, m_beta);
 
-            vertexTransform.setPosition(newX);
-            vertexTransform.setVelocity(newV);
+            cloth.gatherPositions(m_clothPositions);
+            solveParticleCollisions(m_clothPositions, cloth.getThickness());
+            cloth.scatterPositions(m_clothPositions);
         }
 
+        cloth.updateVelocities(deltaTime_s);
+
         subStep++;
     }
 }
 
+void Scene::solveParticleCollisions(
+    std::vector<glm::vec3>& x,
+    float radius
+)
+{
+    #pragma omp parallel
+    {
+        std::vector<int> candidates;
+        #pragma omp for schedule(static)
+        for (long long i = 0; i < static_cast<long long>(x.size()); ++i)
+        {
+            m_staticColliderTree.query(x[i] - radius, x[i] + radius, candidates);
+            for (int c : candidates)
+            {
+                const StaticCollider& collider = m_staticColliders[c];
+                glm::vec3 q = toRestFrame(collider.pose, x[i]);
+                glm::mat3 poseRotation(collider.pose);
+
+                if (m_enableColliderSDF && collider.sdf)
+                {
+                    glm::vec3 gradient;
+                    glm::vec3 p = glm::transpose(collider.rotation) * (q - collider.translation);
+                    float distance = collider.sdf->sample(p, gradient);
+                    float length = glm::length(gradient);
+                    if (distance >= radius || length < 1e-6f) continue;
+
+                    x[i] += (radius - distance) * (poseRotation * collider.rotation * (gradient / length));
+                    continue;
+                }
+
+                TriangleBVH::ClosestPoint closest;
+                if (!collider.bvh.findClosestPoint(q, closest, radius))
+                {
+                    // deeper inside than the radius
+                    glm::vec3 normal;
+                    float depth;
+                    if (!collider.bvh.findContact(q, normal, depth)) continue;
+
+                    closest.normal = normal;
+                    closest.distance = -depth;
+                }
+
+                x[i] += (radius - closest.distance) * (poseRotation * closest.normal);
+            }
+
+            // terrain is tested at the bottom of the particle
+            for (const auto& heightfield : m_heightfields)
+            {
+                glm::vec3 normal;
+                float depth;
+                if (!heightfield->findContact(x[i] - glm::vec3(0.0f, radius, 0.0f), normal, depth)) continue;
+
+                x[i] += depth * normal;
+            }
+        }
+    }
+}
+
+void Scene::launchWorkerProcesses(int numWorkers)
+{
+    // every dynamic object becomes a shared-memory slot owned by one worker
+    std::vector<size_t> slotSizes;
+    for (const auto& obj : m_objects)
+    {
+        if (obj->isStatic()) continue;
+        m_workerObjects.push_back(obj.get());
+        slotSizes.push_back(obj->getVertexTransforms().size());
+    }
+    if (m_workerObjects.empty()) return;
+
+    m_workerPool = std::make_unique<WorkerProcessPool>(numWorkers, slotSizes);
+    if (!m_workerPool->isValid() || !m_workerPool->launch([this](int worker) { runWorker(worker); }))
+    {
+        std::cerr << "Scene: falling back to in-process simulation." << std::endl;
+        m_workerPool.reset();
+        m_workerObjects.clear();
+    }
+}
+
+void Scene::storeWorkerState(size_t slot, uint64_t seq)
+{
+    WorkerProcessPool::ParticleState state = m_workerPool->getState(slot, seq);
+    const auto& vertexTransforms = m_workerObjects[slot]->getVertexTransforms();
+    for (size_t i = 0; i < state.numParticles; ++i)
+    {
+        state.positions[i] = vertexTransforms[i].getPosition();
+        state.velocities[i] = vertexTransforms[i].getVelocity();
+    }
+}
+
+void Scene::loadWorkerState(size_t slot, uint64_t seq)
+{
+    WorkerProcessPool::ParticleState state = m_workerPool->getState(slot, seq);
+    auto& vertexTransforms = m_workerObjects[slot]->getVertexTransforms();
+    for (size_t i = 0; i < state.numParticles; ++i)
+    {
+        vertexTransforms[i].setPosition(state.positions[i]);
+        vertexTransforms[i].setVelocity(state.velocities[i]);
+    }
+}
+
+void Scene::runWorker(int worker)
+{
+    // runs in the forked child: same scene, no GL calls
+    setupSimulation();
+    uint64_t seq = m_workerPool->getLaunchSequence();
+    WorkerProcessPool::FrameParams params;
+
+    while (m_workerPool->waitForFrame(seq, params))
+    {
+        m_pbdSubsteps = params.substeps;
+        m_gravitationalAcceleration = params.gravitationalAcceleration;
+        m_alpha = params.alpha;
+        m_beta = params.beta;
+        m_bendingAlpha = params.bendingAlpha;
+        m_k = params.k;
+        m_enableDistanceConstraints = params.enableDistanceConstraints;
+        m_enableBendingConstraints = params.enableBendingConstraints;
+        m_enableVolumeConstraints = params.enableVolumeConstraints;
+        m_enableEnvCollisionConstraints = params.enableEnvCollisionConstraints;
+        m_enableEnvCollisionGrid = params.enableEnvCollisionGrid;
+        m_enableColliderBVH = params.enableColliderBVH;
+        m_enableColliderSDF = params.enableColliderSDF;
+        m_enableAnalyticColliders = params.enableAnalyticColliders;
+        m_enableConvexHullColliders = params.enableConvexHullColliders;
+        m_enableSoftBodyCollisions = params.enableSoftBodyCollisions;
+        m_enableContinuousCollisions = params.enableContinuousCollisions;
+        m_enableContactReuse = params.enableContactReuse;
+        m_enableContactVelocities = params.enableContactVelocities;
+        m_friction = params.friction;
+        m_restitution = params.restitution;
+        m_continuousCollisionThreshold = params.continuousCollisionThreshold;
+        m_enablePartitionedSolve = params.enablePartitionedSolve;
+
+        m_time = params.time;
+        updateKinematicColliders();
+
+        m_drag.reset();
+        if (params.dragSlot >= 0)
+        {
+            m_drag = DragConstraint{ m_workerObjects[params.dragSlot], params.dragParticle, params.dragTarget };
+        }
+
+        // pick up everybody's state from the end of the previous frame
+        for (size_t slot = 0; slot < m_workerObjects.size(); ++slot)
+        {
+            Object& object = *m_workerObjects[slot];
+            object.enableSelfCollision() = m_workerPool->getSlotParams(slot).enableSelfCollision;
+            loadWorkerState(slot, seq - 1);
+            if (m_enableSoftBodyCollisions)
+            {
+                refitSoftBodyCollider(object);
+            }
+        }
+
+        // advance owned objects by a whole frame and publish them
+        for (size_t slot = 0; slot < m_workerObjects.size(); ++slot)
+        {
+            if (m_workerPool->getOwner(slot) != worker) continue;
+
+            Object& object = *m_workerObjects[slot];
+            applyGravity(object, params.deltaTime);
+            applyPBD(object, params.deltaTime);
+            storeWorkerState(slot, seq);
+        }
+
+        m_workerPool->finishFrame(worker, seq);
+    }
+}
+
+bool Scene::stepWorkerProcesses(float deltaTime)
+{
+    // local state may have been changed (e.g. reset), so publish it first
+    uint64_t seq = m_workerPool->getSequence();
+    for (size_t slot = 0; slot < m_workerObjects.size(); ++slot)
+    {
+        storeWorkerState(slot, seq);
+        m_workerPool->getSlotParams(slot).enableSelfCollision = m_workerObjects[slot]->enableSelfCollision();
+    }
+
+    WorkerProcessPool::FrameParams params;
+    params.deltaTime = deltaTime;
+    params.substeps = m_pbdSubsteps;
+    params.gravitationalAcceleration = m_gravitationalAcceleration;
+    params.alpha = m_alpha;
+    params.beta = m_beta;
+    params.bendingAlpha = m_bendingAlpha;
+    params.k = m_k;
+    params.enableDistanceConstraints = m_enableDistanceConstraints;
+    params.enableBendingConstraints = m_enableBendingConstraints;
+    params.enableVolumeConstraints = m_enableVolumeConstraints;
+    params.enableEnvCollisionConstraints = m_enableEnvCollisionConstraints;
+    params.enableEnvCollisionGrid = m_enableEnvCollisionGrid;
+    params.enableColliderBVH = m_enableColliderBVH;
+    params.enableColliderSDF = m_enableColliderSDF;
+    params.enableAnalyticColliders = m_enableAnalyticColliders;
+    params.enableConvexHullColliders = m_enableConvexHullColliders;
+    params.enableSoftBodyCollisions = m_enableSoftBodyCollisions;
+    params.enableContinuousCollisions = m_enableContinuousCollisions;
+    params.enableContactReuse = m_enableContactReuse;
+    params.enableContactVelocities = m_enableContactVelocities;
+    params.friction = m_friction;
+    params.restitution = m_restitution;
+    params.continuousCollisionThreshold = m_continuousCollisionThreshold;
+    params.enablePartitionedSolve = m_enablePartitionedSolve;
+    params.time = m_time;
+
+    // the dragged object is passed by slot
+    params.dragSlot = -1;
+    params.dragParticle = 0;
+    params.dragTarget = glm::vec3(0.0f);
+    for (size_t slot = 0; m_drag && slot < m_workerObjects.size(); ++slot)
+    {
+        if (m_workerObjects[slot] != m_drag->object) continue;
+        params.dragSlot = static_cast<int>(slot);
+        params.dragParticle = m_drag->particle;
+        params.dragTarget = m_drag->target;
+    }
+
+    // soft bodies owned by different workers see each other as they were at
+    // the start of the frame
+    seq = m_workerPool->publishFrame(params);
+    if (!m_workerPool->waitForWorkers(seq)) return false;
+
+    for (size_t slot = 0; slot < m_workerObjects.size(); ++slot)
+    {
+        loadWorkerState(slot, seq);
+    }
+    return true;
+}
+
 void Scene::update(float deltaTime)
 {
     m_camera->setDeltaTime(deltaTime);
     // m_camera->move();
 
+    // static colliders are hashed once and only again when they move or
+    // change shape
+    if (haveStaticCollidersChanged())
+    {
+        buildStaticColliders();
+    }
+
+    // kinematic colliders move to where they are at the end of this frame
+    m_time += deltaTime;
+    updateKinematicColliders();
+
+    // dynamic objects live in worker processes; the local state is only
+    // replaced once every substep is done, so it is still this frame's start
+    if (m_workerPool && !stepWorkerProcesses(deltaTime))
+    {
+        std::cerr << "Scene: falling back to in-process simulation." << std::endl;
+        m_workerPool.reset();
+        m_workerObjects.clear();
+    }
+
+    // batched gravity and PBD for instances sharing topology
+    if (m_enableInstanceBatching && !m_workerPool)
+    {
+        for (auto& batch : m_instanceBatches)
+        {
+            for (Object* instance : batch->getInstances())
+            {
+                applyGravity(*instance, deltaTime);
+            }
+            applyBatchedPBD(*batch, deltaTime);
+        }
+    }
+
+    for (auto& heightfield : m_heightfields)
+    {
+        heightfield->getTransform().setView(*m_camera);
+    }
+
+    for (auto& fluid : m_fluids)
+    {
+        if (m_enableFluids)
+        {
+            applyFluidPBD(*fluid, deltaTime);
+        }
+        fluid->getTransform().setView(*m_camera);
+    }
+
+    for (auto& cloth : m_cloths)
+    {
+        if (m_enableCloth)
+        {
+            applyClothPBD(*cloth, deltaTime);
+        }
+        cloth->getTransform().setView(*m_camera);
+    }
+
     // gravity and PBD
     for (auto& object : m_objects)
     {
         Transform& transform = object->getTransform();
         transform.setView(*m_camera);
 
-        if (!object->isStatic())
+        bool isBatched = m_enableInstanceBatching && m_batchedObjects.count(object.get());
+        if (!object->isStatic() && !isBatched && !m_workerPool)
         {
             applyGravity(*object, deltaTime);
             applyPBD(*object, deltaTime);
         }
 
         object->update(deltaTime);
+
+        // the next bodies collide against this one's new shape, and scene
+        // queries see where it is now
+        if (!object->isStatic())
+        {
+            refitSoftBodyCollider(*object);
+        }
+
+        // tearing changes the particle count, which the worker slots can't follow
+        if (m_enableTearing && !object->isStatic() && !m_workerPool)
+        {
+            if (object->tear(m_tearStrain, m_maxTearsPerFrame) > 0 && m_batchedObjects.count(object.get()))
+            {
+                removeFromInstanceBatch(*object);
+            }
+        }
+    }
+}
+
+void Scene::resetObjects()
+{
+    bool wasTorn = false;
+    for (auto& object : m_objects)
+    {
+        wasTorn |= object->isTorn();
+        object->resetVertexTransforms();
+    }
+
+    for (auto& fluid : m_fluids)
+    {
+        fluid->reset();
+    }
+
+    for (auto& cloth : m_cloths)
+    {
+        cloth->reset();
+    }
+
+    // kinematic colliders start their motion over
+    m_time = 0.0f;
+    updateKinematicColliders();
+    for (auto& collider : m_staticColliders)
+    {
+        collider.previousPose = collider.pose;
+    }
+
+    // restored instances can be batched again
+    if (wasTorn)
+    {
+        m_instanceBatches.clear();
+        m_batchedObjects.clear();
+        buildInstanceBatches();
     }
 }
 
@@ -538,14 +2392,33 @@ void Scene::render()
         object->render();
     }
 
+    for (const auto& heightfield : m_heightfields)
+    {
+        heightfield->render();
+    }
+
+    for (const auto& fluid : m_fluids)
+    {
+        fluid->render();
+    }
+
+    for (const auto& cloth : m_cloths)
+    {
+        cloth->render();
+    }
 }
 
 void Scene::clear()
 {
+    m_workerPool.reset();
+
     m_textureManager->deleteAllResources();
     m_meshManager->deleteAllResources();
     m_shaderManager->deleteAllResources();
     m_objects.clear();
+    m_heightfields.clear();
+    m_fluids.clear();
+    m_cloths.clear();
 
     std::cout << m_name << " cleared.\n";
 }
\ No newline at end of file
@@ -1,8 +1,13 @@
 #pragma once
 
+#include <filesystem>
 #include <span>
 #include <string>
 #include <vector>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <omp.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
@@ -12,6 +17,18 @@
 #include "TextureManager.hpp"
 #include "Camera.hpp"
 #include "Object.hpp"
+#include "InstanceBatch.hpp"
+#include "SpatialHash.hpp"
+#include "TriangleBVH.hpp"
+#include "SignedDistanceField.hpp"
+#include "ConvexHull.hpp"
+#include "DynamicAABBTree.hpp"
+#include "ParticleHash.hpp"
+#include "Heightfield.hpp"
+#include "FluidSystem.hpp"
+#include "Cloth.hpp"
+#include "SceneQuery.hpp"
+#include "WorkerProcessPool.hpp"
 
 
 class Scene
@@ -22,15 +39,31 @@ public:
         std::unique_ptr<ShaderManager> shaderManager,
         std::unique_ptr<MeshManager> meshManager,
         std::unique_ptr<TextureManager> textureManager,
-        std::unique_ptr<Camera>
+        std::unique_ptr<Camera>,
+        int numWorkerProcesses = 0
     );
 
     void update(float deltaTime);
+    int getNumWorkerProcesses() const { return m_workerPool ? m_workerPool->getNumWorkers() : 0; }
     void render();
     void clear();
+    void resetObjects();
 
     Camera* getCamera() { return m_camera.get(); }
     const std::vector<std::unique_ptr<Object>>& getObjects() const { return m_objects; }
+    const std::vector<std::unique_ptr<Heightfield>>& getHeightfields() const { return m_heightfields; }
+    const std::vector<std::unique_ptr<FluidSystem>>& getFluids() const { return m_fluids; }
+    const std::vector<std::unique_ptr<Cloth>>& getCloths() const { return m_cloths; }
+
+    // raycasts, overlaps and closest points against the current state
+    SceneQuery getQuery() const { return SceneQuery(*this); }
+
+    // pulls one particle of a dynamic object towards a target until released
+    void beginDrag(const Object& object, unsigned int particle, const glm::vec3& target);
+    void moveDrag(const glm::vec3& target);
+    void endDrag() { m_drag.reset(); }
+    bool isDragging() const { return m_drag.has_value(); }
+    const Object* getDraggedObject() const { return m_drag ? m_drag->object : nullptr; }
 
     bool& enableDistanceConstraints() { return m_enableDistanceConstraints; }
     void solveDistanceConstraints(
@@ -42,6 +75,37 @@ public:
         const Mesh::DistanceConstraints& distanceConstraints
     );
 
+    void solveDistanceConstraint(
+        size_t j,
+        std::vector<glm::vec3>& x,
+        const std::vector<glm::vec3>& posDiff,
+        const std::vector<float>& M,
+        float alphaTilde,
+        float gamma,
+        const Mesh::DistanceConstraints& distanceConstraints
+    );
+
+    bool& enablePartitionedSolve() { return m_enablePartitionedSolve; }
+    void solveDistanceConstraintsPartitioned(
+        std::vector<glm::vec3>& x,
+        const std::vector<glm::vec3>& posDiff,
+        const std::vector<float>& M,
+        float alphaTilde,
+        float gamma,
+        const Mesh::DistanceConstraints& distanceConstraints,
+        const MeshPartition& partition
+    );
+
+    bool& enableBendingConstraints() { return m_enableBendingConstraints; }
+    void solveBendingConstraints(
+        std::vector<glm::vec3>& x,
+        const std::vector<glm::vec3>& posDiff,
+        const std::vector<float>& M,
+        float alphaTilde,
+        float gamma,
+        const Mesh::BendingConstraints& bendingConstraints
+    );
+
     bool& enableVolumeConstraints() { return m_enableVolumeConstraints; }
     void solveVolumeConstraints(
         std::vector<glm::vec3>& x,
@@ -59,18 +123,142 @@ public:
         const std::vector<float>& M,
         float alphaTilde,
         float gamma,
-        std::vector<Mesh::EnvCollisionConstraints> perEnvCollisionConstraints
+        std::vector<Mesh::EnvCollisionConstraints>& perEnvCollisionConstraints
+    );
+
+    bool& enableEnvCollisionGrid() { return m_enableEnvCollisionGrid; }
+    const SpatialHash& getEnvCollisionGrid() const { return m_envCollisionGrid; }
+    bool& enableColliderBVH() { return m_enableColliderBVH; }
+    bool& enableColliderSDF() { return m_enableColliderSDF; }
+    bool& enableAnalyticColliders() { return m_enableAnalyticColliders; }
+    bool& enableConvexHullColliders() { return m_enableConvexHullColliders; }
+
+    void solveSelfCollisions(
+        Object& object,
+        std::vector<glm::vec3>& x,
+        const std::vector<glm::vec3>& posDiff,
+        const std::vector<float>& M,
+        float alphaTilde,
+        float gamma
+    );
+
+    // contacts against static colliders, found once per frame and solved as
+    // planes in every substep; planes on kinematic colliders move with them.
+    // depth is how far the last substep pushed the particle out, 0 if the
+    // contact was not active
+    struct Contact
+    {
+        unsigned int vertex;
+        glm::vec3 point;
+        glm::vec3 normal;
+        glm::vec3 velocity = glm::vec3(0.0f);
+        float depth = 0.0f;
+    };
+
+    bool& enableContactReuse() { return m_enableContactReuse; }
+    void gatherContacts(
+        const Object& object,
+        float deltaTime,
+        std::vector<Contact>& contacts
+    );
+    void solveContacts(
+        std::vector<glm::vec3>& x,
+        const std::vector<glm::vec3>& posDiff,
+        const std::vector<float>& M,
+        float alphaTilde,
+        float gamma,
+        std::vector<Contact>& contacts,
+        float time
+    );
+
+    // Coulomb friction and restitution on the contacts that were active in
+    // the substep, applied to the velocities derived from the positions
+    bool& enableContactVelocities() { return m_enableContactVelocities; }
+    float& getFriction() { return m_friction; }
+    float& getRestitution() { return m_restitution; }
+    void solveContactVelocities(
+        std::vector<glm::vec3>& v,
+        const std::vector<glm::vec3>& posDiff,
+        const std::vector<Contact>& contacts,
+        float deltaTime_s
+    );
+
+    bool& enableContinuousCollisions() { return m_enableContinuousCollisions; }
+    float& getContinuousCollisionThreshold() { return m_continuousCollisionThreshold; }
+    void solveContinuousCollisions(
+        std::vector<glm::vec3>& x,
+        const std::vector<glm::vec3>& posDiff,
+        const std::vector<float>& M,
+        float alphaTilde,
+        float gamma
     );
 
+    void solveHeightfieldCollisions(
+        std::vector<glm::vec3>& x,
+        const std::vector<glm::vec3>& posDiff,
+        const std::vector<float>& M,
+        float alphaTilde,
+        float gamma
+    );
+
+    bool& enableSoftBodyCollisions() { return m_enableSoftBodyCollisions; }
+    void solveSoftBodyCollisions(
+        const Object& object,
+        std::vector<glm::vec3>& x,
+        const std::vector<glm::vec3>& posDiff,
+        const std::vector<float>& M,
+        float alphaTilde,
+        float gamma
+    );
+
+    void solveDragConstraint(
+        std::vector<glm::vec3>& x,
+        const std::vector<glm::vec3>& posDiff,
+        const std::vector<float>& M,
+        float alphaTilde,
+        float gamma
+    );
+
+    // fluid and cloth particles are pushed out of the static colliders and
+    // terrain to their radius; they don't interact with the soft bodies
+    bool& enableFluids() { return m_enableFluids; }
+    bool& enableCloth() { return m_enableCloth; }
+    void solveParticleCollisions(
+        std::vector<glm::vec3>& x,
+        float radius
+    );
+
+    bool& enableTearing() { return m_enableTearing; }
+    float& getTearStrain() { return m_tearStrain; }
+
+    bool& enableInstanceBatching() { return m_enableInstanceBatching; }
+    size_t getNumInstanceBatches() const { return m_instanceBatches.size(); }
+
     glm::vec3& getGravitationalAcceleration() { return m_gravitationalAcceleration; }
     int& getPBDSubsteps() { return m_pbdSubsteps; }
     float& getAlpha() { return m_alpha; }
     float& getBeta()  { return m_beta;  }
+    float& getBendingAlpha() { return m_bendingAlpha; }
     float& getOverpressureFactor() { return m_k; }
 
 private:
+    friend class SceneQuery;
+
     void createObjects();
     void setupEnvCollisionConstraints();
+    void buildStaticColliders();
+    bool haveStaticCollidersChanged() const;
+    void updateKinematicColliders();
+    static glm::vec3 toRestFrame(const glm::mat4& pose, const glm::vec3& p);
+    static glm::vec3 fromRestFrame(const glm::mat4& pose, const glm::vec3& p);
+    static void transformBounds(const glm::mat4& pose, glm::vec3& min, glm::vec3& max);
+    void buildSoftBodyColliders();
+    void refitSoftBodyCollider(Object& object);
+    std::shared_ptr<const SignedDistanceField> getSignedDistanceField(
+        const std::vector<glm::vec3>& localPositions,
+        const std::vector<Triangle>& triangles,
+        const glm::vec3& scale
+    );
     void applyGravity(
         Object& object,
         float deltaTime
@@ -84,16 +272,38 @@ private:
         float alphaTilde,
         float gamma
     );
-    std::vector<glm::vec3> calculateDeltaX(
+    void applyDeltaX(
+        std::vector<glm::vec3>& x,
         float lambda,
         const std::vector<float>& M,
-        std::vector<glm::vec3>& gradC_j,
+        const std::vector<glm::vec3>& gradC_j,
         std::span<const unsigned int> constraintVertices
     );
     void applyPBD(
         Object& object,
         float deltaTime
     );
+    void buildInstanceBatches();
+    void removeFromInstanceBatch(const Object& object);
+    void setupMeshPartitions();
+    void setupSimulation();
+    void launchWorkerProcesses(int numWorkers);
+    void storeWorkerState(size_t slot, uint64_t seq);
+    void loadWorkerState(size_t slot, uint64_t seq);
+    void runWorker(int worker);
+    bool stepWorkerProcesses(float deltaTime);
+    void applyBatchedPBD(
+        InstanceBatch& batch,
+        float deltaTime
+    );
+    void applyFluidPBD(
+        FluidSystem& fluid,
+        float deltaTime
+    );
+    void applyClothPBD(
+        Cloth& cloth,
+        float deltaTime
+    );
 
 private:
     std::string m_name;
@@ -105,16 +315,123 @@ private:
     std::unique_ptr<Camera> m_camera;
 
     std::vector<std::unique_ptr<Object>> m_objects;
+    std::vector<std::unique_ptr<InstanceBatch>> m_instanceBatches;
+    std::unordered_set<const Object*> m_batchedObjects;
+
+    // terrain is queried directly rather than through the collision closures
+    std::vector<std::unique_ptr<Heightfield>> m_heightfields;
+
+    // particle fluids, stepped in the main process only
+    std::vector<std::unique_ptr<FluidSystem>> m_fluids;
+
+    // grid cloths, also stepped in the main process only
+    std::vector<std::unique_ptr<Cloth>> m_cloths;
+    std::vector<glm::vec3> m_clothPositions;
+
+    // world-space BVH plus an SDF in the collider's rigid frame, so only the
+    // scale is baked into the field
+    struct StaticCollider
+    {
+        const Object* object;
+        TriangleBVH bvh;
+        std::shared_ptr<const SignedDistanceField> sdf;
+        std::optional<ColliderShape> shape;
+        std::optional<ConvexHull> hull;
+        glm::mat3 rotation;
+        glm::vec3 translation;
+        glm::mat4 model;
+
+        // kinematic colliders keep their baked geometry and move rigidly on
+        // top of it; previousPose is where they were one step earlier
+        bool isKinematic;
+        glm::mat4 pose;
+        glm::mat4 previousPose;
+
+        // leaf in the tree scene queries find colliders with
+        int proxy;
+    };
+
+    SpatialHash m_envCollisionGrid;
+    std::vector<StaticCollider> m_staticColliders;
+    DynamicAABBTree m_staticColliderTree;
+    std::unordered_map<uint64_t, std::shared_ptr<const SignedDistanceField>> m_signedDistanceFields;
+    uint32_t m_numFieldLookups = 0;     // fields not found in memory, matched across processes
+
+    // last GJK simplex per static collider and particle, collider major
+    std::unordered_map<const Object*, std::vector<ConvexHull::Simplex>> m_hullSimplices;
+
+    // soft bodies collide with each other through a tree over their bounds
+    // and a triangle BVH per body that is refitted as it deforms
+    struct SoftBodyCollider
+    {
+        const Object* object;
+        int proxy;
+        TriangleBVH bvh;
+        size_t numPositions;
+        float inverseMass;
+    };
+
+    DynamicAABBTree m_softBodyTree;
+    std::vector<SoftBodyCollider> m_softBodyColliders;
+    std::unordered_map<const Object*, size_t> m_softBodyColliderIndices;
+    std::vector<glm::vec3> m_refitPositions;
+
+    ParticleHash m_selfCollisionHash;
+    std::vector<unsigned int> m_selfCollisionOffsets;
+    std::vector<unsigned int> m_selfCollisionPairs;
+    Adjacency m_selfCollisionTriangles;
+
+    // per-thread contact buffers and their offsets in the compacted list
+    std::vector<std::vector<Contact>> m_contactBuffers;
+    std::vector<size_t> m_contactOffsets;
+
+    // particle held by the pick-and-drag tool
+    struct DragConstraint
+    {
+        const Object* object;
+        unsigned int particle;
+        glm::vec3 target;
+    };
+
+    std::optional<DragConstraint> m_drag;
+
+    std::unique_ptr<WorkerProcessPool> m_workerPool;
+    std::vector<Object*> m_workerObjects;
 
     glm::vec3 m_gravitationalAcceleration;
 
     int m_pbdSubsteps;
+    float m_time;
 
     bool m_enableDistanceConstraints;
+    bool m_enableBendingConstraints;
     bool m_enableVolumeConstraints;
     bool m_enableEnvCollisionConstraints;
+    bool m_enableEnvCollisionGrid;
+    bool m_enableColliderBVH;
+    bool m_enableColliderSDF;
+    bool m_enableAnalyticColliders;
+    bool m_enableConvexHullColliders;
+    bool m_enableSoftBodyCollisions;
+    bool m_enableContinuousCollisions;
+    bool m_enableContactReuse;
+    bool m_enableContactVelocities;
+    bool m_enableInstanceBatching;
+    bool m_enablePartitionedSolve;
+    bool m_enableTearing;
+    bool m_enableFluids;
+    bool m_enableCloth;
+    size_t m_minVerticesPerDomain;
 
     float m_alpha;
     float m_beta;
+    float m_bendingAlpha;
     float m_k;
+    float m_tearStrain;
+    float m_continuousCollisionThreshold;
+    float m_contactMargin;
+    float m_friction;
+    float m_restitution;
+    float m_dragAlpha;
+    int m_maxTearsPerFrame;
 };
\ No newline at end of file
@@ -0,0 +1,231 @@
+#include "SceneQuery.hpp"
+
+#include <cmath>
+#include <limits>
+
+#include "Scene.hpp"
+
+namespace
+{
+    // surface point within maxDistance of p; a p deeper inside than that still
+    // counts, with the surface point it would be pushed out to
+    bool findSurfacePoint(const TriangleBVH& bvh, const glm::vec3& p, float maxDistance, TriangleBVH::ClosestPoint& closest)
+    {
+        if (bvh.findClosestPoint(p, closest, maxDistance)) return true;
+
+        glm::vec3 normal;
+        float depth;
+        if (!bvh.findContact(p, normal, depth)) return false;
+
+        closest.point = p + depth * normal;
+        closest.normal = normal;
+        closest.distance = -depth;
+        return true;
+    }
+}
+
+bool SceneQuery::raycast(const Ray& ray, Hit& hit) const
+{
+    float maxDistance = ray.maxDistance;
+    bool found = false;
+    std::vector<int> candidates;
+
+    // static colliders are cast against in their rest frame
+    m_scene.m_staticColliderTree.raycast(ray.origin, ray.direction, maxDistance, candidates);
+    for (int c : candidates)
+    {
+        const Scene::StaticCollider& collider = m_scene.m_staticColliders[c];
+        glm::vec3 origin = Scene::toRestFrame(collider.pose, ray.origin);
+        glm::vec3 direction = glm::transpose(glm::mat3(collider.pose)) * ray.direction;
+
+        TriangleBVH::RayHit rayHit;
+        if (!collider.bvh.raycast(origin, direction, maxDistance, rayHit)) continue;
+
+        maxDistance = rayHit.t;
+        hit = {
+            collider.object,
+            nullptr,
+            Scene::fromRestFrame(collider.pose, rayHit.point),
+            glm::mat3(collider.pose) * rayHit.normal,
+            rayHit.t,
+            -1
+        };
+        found = true;
+    }
+
+    m_scene.m_softBodyTree.raycast(ray.origin, ray.direction, maxDistance, candidates);
+    for (int c : candidates)
+    {
+        const Scene::SoftBodyCollider& collider = m_scene.m_softBodyColliders[c];
+
+        TriangleBVH::RayHit rayHit;
+        if (!collider.bvh.raycast(ray.origin, ray.direction, maxDistance, rayHit)) continue;
+
+        maxDistance = rayHit.t;
+        hit = {
+            collider.object,
+            nullptr,
+            rayHit.point,
+            rayHit.normal,
+            rayHit.t,
+            findNearestParticle(*collider.object, rayHit.triangle, rayHit.point)
+        };
+        found = true;
+    }
+
+    for (const auto& heightfield : m_scene.m_heightfields)
+    {
+        float t;
+        glm::vec3 normal;
+        if (!heightfield->raycast(ray.origin, ray.direction, maxDistance, t, normal)) continue;
+
+        maxDistance = t;
+        hit = { nullptr, heightfield.get(), ray.origin + t * ray.direction, normal, t, -1 };
+        found = true;
+    }
+
+    return found;
+}
+
+void SceneQuery::raycast(const std::vector<Ray>& rays, std::vector<std::optional<Hit>>& hits) const
+{
+    hits.assign(rays.size(), std::nullopt);
+
+    #pragma omp parallel for schedule(dynamic, 64)
+    for (long long i = 0; i < static_cast<long long>(rays.size()); ++i)
+    {
+        Hit hit;
+        if (raycast(rays[i], hit)) hits[i] = hit;
+    }
+}
+
+void SceneQuery::overlapSphere(const Sphere& sphere, std::vector<Overlap>& overlaps) const
+{
+    overlaps.clear();
+    std::vector<int> candidates;
+    glm::vec3 min = sphere.center - sphere.radius;
+    glm::vec3 max = sphere.center + sphere.radius;
+
+    m_scene.m_staticColliderTree.query(min, max, candidates);
+    for (int c : candidates)
+    {
+        const Scene::StaticCollider& collider = m_scene.m_staticColliders[c];
+        glm::vec3 center = Scene::toRestFrame(collider.pose, sphere.center);
+
+        TriangleBVH::ClosestPoint closest;
+        if (!findSurfacePoint(collider.bvh, center, sphere.radius, closest)) continue;
+
+        overlaps.push_back({ collider.object, Scene::fromRestFrame(collider.pose, closest.point), closest.distance });
+    }
+
+    m_scene.m_softBodyTree.query(min, max, candidates);
+    for (int c : candidates)
+    {
+        const Scene::SoftBodyCollider& collider = m_scene.m_softBodyColliders[c];
+
+        TriangleBVH::ClosestPoint closest;
+        if (!findSurfacePoint(collider.bvh, sphere.center, sphere.radius, closest)) continue;
+
+        overlaps.push_back({ collider.object, closest.point, closest.distance });
+    }
+}
+
+void SceneQuery::overlapSpheres(const std::vector<Sphere>& spheres, std::vector<std::vector<Overlap>>& overlaps) const
+{
+    overlaps.resize(spheres.size());
+
+    #pragma omp parallel for schedule(dynamic, 64)
+    for (long long i = 0; i < static_cast<long long>(spheres.size()); ++i)
+    {
+        overlapSphere(spheres[i], overlaps[i]);
+    }
+}
+
+bool SceneQuery::findClosestPoint(const glm::vec3& p, float maxDistance, Hit& hit) const
+{
+    bool found = false;
+    std::vector<int> candidates;
+
+    m_scene.m_staticColliderTree.query(p - maxDistance, p + maxDistance, candidates);
+    for (int c : candidates)
+    {
+        const Scene::StaticCollider& collider = m_scene.m_staticColliders[c];
+
+        TriangleBVH::ClosestPoint closest;
+        if (!collider.bvh.findClosestPoint(Scene::toRestFrame(collider.pose, p), closest, maxDistance)) continue;
+
+        maxDistance = std::abs(closest.distance);
+        hit = {
+            collider.object,
+            nullptr,
+            Scene::fromRestFrame(collider.pose, closest.point),
+            glm::mat3(collider.pose) * closest.normal,
+            closest.distance,
+            -1
+        };
+        found = true;
+    }
+
+    m_scene.m_softBodyTree.query(p - maxDistance, p + maxDistance, candidates);
+    for (int c : candidates)
+    {
+        const Scene::SoftBodyCollider& collider = m_scene.m_softBodyColliders[c];
+
+        TriangleBVH::ClosestPoint closest;
+        if (!collider.bvh.findClosestPoint(p, closest, maxDistance)) continue;
+
+        maxDistance = std::abs(closest.distance);
+        hit = {
+            collider.object,
+            nullptr,
+            closest.point,
+            closest.normal,
+            closest.distance,
+            findNearestParticle(*collider.object, closest.triangle, closest.point)
+        };
+        found = true;
+    }
+
+    return found;
+}
+
+void SceneQuery::findClosestPoints(
+    const std::vector<glm::vec3>& points,
+    float maxDistance,
+    std::vector<std::optional<Hit>>& hits
+) const
+{
+    hits.assign(points.size(), std::nullopt);
+
+    #pragma omp parallel for schedule(dynamic, 64)
+    for (long long i = 0; i < static_cast<long long>(points.size()); ++i)
+    {
+        Hit hit;
+        if (findClosestPoint(points[i], maxDistance, hit)) hits[i] = hit;
+    }
+}
+
+int SceneQuery::findNearestParticle(const Object& object, unsigned int triangle, const glm::vec3& point) const
+{
+    // soft body BVHs report triangles by their index in the mesh
+    const auto& triangles = object.getMesh().volumeConstraints.triangles;
+    const auto& vertexTransforms = object.getVertexTransforms();
+    if (triangle >= triangles.size()) return -1;
+
+    const Triangle& tri = triangles[triangle];
+    int nearest = -1;
+    float nearest2 = std::numeric_limits<float>::max();
+    for (unsigned int v : { tri.v1, tri.v2, tri.v3 })
+    {
+        if (v >= vertexTransforms.size()) continue;
+
+        glm::vec3 d = vertexTransforms[v].getPosition() - point;
+        float d2 = glm::dot(d, d);
+        if (d2 < nearest2)
+        {
+            nearest2 = d2;
+            nearest = static_cast<int>(v);
+        }
+    }
+    return nearest;
+}
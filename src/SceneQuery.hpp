@@ -0,0 +1,70 @@
+#pragma once
+
+#include <optional>
+#include <vector>
+#include <glm/glm.hpp>
+
+class Scene;
+class Object;
+class Heightfield;
+
+// Raycasts, sphere overlaps and closest points against everything in a scene.
+// Candidates come from the broadphase trees over the static colliders and the
+// soft bodies and are resolved against their triangle BVHs, so a query never
+// scans the object list. Batches are split over threads; queries only read
+// the scene, so they must not overlap with Scene::update.
+class SceneQuery
+{
+public:
+    struct Ray
+    {
+        glm::vec3 origin;
+        glm::vec3 direction;    // unit length
+        float maxDistance;
+    };
+
+    struct Sphere
+    {
+        glm::vec3 center;
+        float radius;
+    };
+
+    struct Hit
+    {
+        const Object* object;               // nullptr for terrain
+        const Heightfield* heightfield;     // nullptr for objects
+        glm::vec3 point;
+        glm::vec3 normal;
+        float distance;                     // along the ray, or signed from the queried point
+        int particle;                       // nearest particle on a soft body, -1 otherwise
+    };
+
+    struct Overlap
+    {
+        const Object* object;
+        glm::vec3 point;        // closest point on the surface
+        float distance;         // signed, negative if the center is inside
+    };
+
+    explicit SceneQuery(const Scene& scene) : m_scene(scene) {}
+
+    bool raycast(const Ray& ray, Hit& hit) const;
+    void raycast(const std::vector<Ray>& rays, std::vector<std::optional<Hit>>& hits) const;
+
+    // every object whose surface is within the radius or that contains the center
+    void overlapSphere(const Sphere& sphere, std::vector<Overlap>& overlaps) const;
+    void overlapSpheres(const std::vector<Sphere>& spheres, std::vector<std::vector<Overlap>>& overlaps) const;
+
+    // closest surface point of any object within maxDistance
+    bool findClosestPoint(const glm::vec3& p, float maxDistance, Hit& hit) const;
+    void findClosestPoints(
+        const std::vector<glm::vec3>& points,
+        float maxDistance,
+        std::vector<std::optional<Hit>>& hits
+    ) const;
+
+private:
+    int findNearestParticle(const Object& object, unsigned int triangle, const glm::vec3& point) const;
+
+    const Scene& m_scene;
+};
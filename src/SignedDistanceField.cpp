@@ -0,0 +1,243 @@
+#include "SignedDistanceField.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+static constexpr uint32_t SdfFileMagic = 0x31464453; // "SDF1"
+
+uint64_t SignedDistanceField::calculateKey(
+    const std::vector<glm::vec3>& localPositions,
+    const std::vector<Triangle>& triangles,
+    const glm::vec3& scale,
+    float voxelSize
+)
+{
+    // FNV-1a
+    uint64_t hash = 14695981039346656037ull;
+    auto mix = [&](const void* data, size_t size) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; ++i)
+        {
+            hash ^= bytes[i];
+            hash *= 1099511628211ull;
+        }
+    };
+
+    mix(&SdfFileMagic, sizeof(SdfFileMagic));
+    mix(localPositions.data(), localPositions.size() * sizeof(glm::vec3));
+    mix(triangles.data(), triangles.size() * sizeof(Triangle));
+    mix(&scale, sizeof(scale));
+    mix(&voxelSize, sizeof(voxelSize));
+    return hash;
+}
+
+size_t SignedDistanceField::getBrick(const glm::ivec3& brick) const
+{
+    return (static_cast<size_t>(brick.z) * m_numBricks.y + brick.y) * m_numBricks.x + brick.x;
+}
+
+glm::vec3 SignedDistanceField::getBrickCentre(const glm::ivec3& brick) const
+{
+    return m_origin + (glm::vec3(brick) + 0.5f) * (BrickSize * m_voxelSize);
+}
+
+void SignedDistanceField::bake(const TriangleBVH& bvh, float voxelSize)
+{
+    m_voxelSize = voxelSize;
+
+    // one voxel of padding around the surface
+    glm::vec3 min = bvh.getMin() - voxelSize;
+    glm::vec3 max = bvh.getMax() + voxelSize;
+    float brickExtent = BrickSize * voxelSize;
+    m_origin = min;
+    m_numBricks = glm::max(glm::ivec3(glm::ceil((max - min) / brickExtent)), glm::ivec3(1));
+
+    size_t numBricks = static_cast<size_t>(m_numBricks.x) * m_numBricks.y * m_numBricks.z;
+    m_coarse.assign(numBricks, glm::vec4(0.0f));
+    m_brickIndex.assign(numBricks, -1);
+
+    auto signedDistance = [&](const glm::vec3& p, glm::vec3& gradient) {
+        TriangleBVH::ClosestPoint closest;
+        bvh.findClosestPoint(p, closest);
+        glm::vec3 d = p - closest.point;
+        float length = glm::length(d);
+        gradient = length > 1e-6f ? (closest.distance < 0.0f ? -d : d) / length : closest.normal;
+        return closest.distance;
+    };
+
+    // a brick can only contain surface if its centre is closer than its half diagonal
+    const float reach = 0.5f * std::sqrt(3.0f) * brickExtent + voxelSize;
+    #pragma omp parallel for schedule(dynamic, 16)
+    for (long long b = 0; b < static_cast<long long>(numBricks); ++b)
+    {
+        glm::ivec3 brick(
+            static_cast<int>(b % m_numBricks.x),
+            static_cast<int>((b / m_numBricks.x) % m_numBricks.y),
+            static_cast<int>(b / (static_cast<long long>(m_numBricks.x) * m_numBricks.y))
+        );
+        glm::vec3 gradient;
+        float d = signedDistance(getBrickCentre(brick), gradient);
+        m_coarse[b] = glm::vec4(d, gradient);
+    }
+
+    int numAllocated = 0;
+    for (size_t b = 0; b < numBricks; ++b)
+    {
+        if (std::abs(m_coarse[b].x) <= reach) m_brickIndex[b] = numAllocated++;
+    }
+
+    m_samples.assign(static_cast<size_t>(numAllocated) * SamplesPerBrick, 0.0f);
+    #pragma omp parallel for schedule(dynamic, 4)
+    for (long long b = 0; b < static_cast<long long>(numBricks); ++b)
+    {
+        int index = m_brickIndex[b];
+        if (index < 0) continue;
+
+        glm::ivec3 brick(
+            static_cast<int>(b % m_numBricks.x),
+            static_cast<int>((b / m_numBricks.x) % m_numBricks.y),
+            static_cast<int>(b / (static_cast<long long>(m_numBricks.x) * m_numBricks.y))
+        );
+        float* samples = &m_samples[static_cast<size_t>(index) * SamplesPerBrick];
+        for (int z = 0; z < SamplesPerAxis; ++z)
+        {
+            for (int y = 0; y < SamplesPerAxis; ++y)
+            {
+                for (int x = 0; x < SamplesPerAxis; ++x)
+                {
+                    glm::vec3 p = m_origin + glm::vec3(brick * BrickSize + glm::ivec3(x, y, z)) * voxelSize;
+                    glm::vec3 gradient;
+                    samples[(z * SamplesPerAxis + y) * SamplesPerAxis + x] = signedDistance(p, gradient);
+                }
+            }
+        }
+    }
+}
+
+float SignedDistanceField::sample(const glm::vec3& p, glm::vec3& gradient) const
+{
+    glm::vec3 u = (p - m_origin) / m_voxelSize;
+    glm::ivec3 brick = glm::ivec3(glm::floor(u / static_cast<float>(BrickSize)));
+
+    // outside the domain: distance to the domain box, which is outside the surface
+    if (glm::any(glm::lessThan(brick, glm::ivec3(0))) || glm::any(glm::greaterThanEqual(brick, m_numBricks)))
+    {
+        glm::vec3 max = m_origin + glm::vec3(m_numBricks * BrickSize) * m_voxelSize;
+        glm::vec3 d = glm::max(glm::max(m_origin - p, p - max), glm::vec3(0.0f));
+        gradient = glm::vec3(0.0f);
+        return glm::length(d);
+    }
+
+    size_t b = getBrick(brick);
+    int index = m_brickIndex[b];
+    if (index < 0)
+    {
+        const glm::vec4& coarse = m_coarse[b];
+        gradient = glm::vec3(coarse.y, coarse.z, coarse.w);
+        return coarse.x + glm::dot(gradient, p - getBrickCentre(brick));
+    }
+
+    glm::vec3 f = u - glm::vec3(brick * BrickSize);
+    glm::ivec3 i = glm::min(glm::ivec3(f), glm::ivec3(BrickSize - 1));
+    glm::vec3 t = f - glm::vec3(i);
+
+    const float* samples = &m_samples[static_cast<size_t>(index) * SamplesPerBrick];
+    auto at = [&](int x, int y, int z) {
+        return samples[((i.z + z) * SamplesPerAxis + (i.y + y)) * SamplesPerAxis + (i.x + x)];
+    };
+
+    float c000 = at(0, 0, 0), c100 = at(1, 0, 0), c010 = at(0, 1, 0), c110 = at(1, 1, 0);
+    float c001 = at(0, 0, 1), c101 = at(1, 0, 1), c011 = at(0, 1, 1), c111 = at(1, 1, 1);
+
+    float c00 = glm::mix(c000, c100, t.x);
+    float c10 = glm::mix(c010, c110, t.x);
+    float c01 = glm::mix(c001, c101, t.x);
+    float c11 = glm::mix(c011, c111, t.x);
+    float c0 = glm::mix(c00, c10, t.y);
+    float c1 = glm::mix(c01, c11, t.y);
+
+    // analytic derivative of the trilinear interpolation
+    float dx = glm::mix(glm::mix(c100 - c000, c110 - c010, t.y), glm::mix(c101 - c001, c111 - c011, t.y), t.z);
+    float dy = glm::mix(c10 - c00, c11 - c01, t.z);
+    float dz = c1 - c0;
+    gradient = glm::vec3(dx, dy, dz) / m_voxelSize;
+
+    return glm::mix(c0, c1, t.z);
+}
+
+bool SignedDistanceField::save(const std::string& path, uint64_t key) const
+{
+    std::ofstream file(path, std::ios::binary);
+    if (!file)
+    {
+        std::cerr << "SignedDistanceField: could not write " << path << std::endl;
+        return false;
+    }
+
+    uint64_t numBricks = m_brickIndex.size();
+    uint64_t numSamples = m_samples.size();
+    file.write(reinterpret_cast<const char*>(&SdfFileMagic), sizeof(SdfFileMagic));
+    file.write(reinterpret_cast<const char*>(&key), sizeof(key));
+    file.write(reinterpret_cast<const char*>(&m_origin), sizeof(m_origin));
+    file.write(reinterpret_cast<const char*>(&m_voxelSize), sizeof(m_voxelSize));
+    file.write(reinterpret_cast<const char*>(&m_numBricks), sizeof(m_numBricks));
+    file.write(reinterpret_cast<const char*>(&numBricks), sizeof(numBricks));
+    file.write(reinterpret_cast<const char*>(&numSamples), sizeof(numSamples));
+    file.write(reinterpret_cast<const char*>(m_brickIndex.data()), numBricks * sizeof(int));
+    file.write(reinterpret_cast<const char*>(m_coarse.data()), numBricks * sizeof(glm::vec4));
+    file.write(reinterpret_cast<const char*>(m_samples.data()), numSamples * sizeof(float));
+    return static_cast<bool>(file);
+}
+
+bool SignedDistanceField::load(const std::string& path, uint64_t key)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return false;
+
+    uint32_t magic = 0;
+    uint64_t fileKey = 0;
+    uint64_t numBricks = 0;
+    uint64_t numSamples = 0;
+    file.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+    file.read(reinterpret_cast<char*>(&fileKey), sizeof(fileKey));
+    if (!file || magic != SdfFileMagic || fileKey != key) return false;
+
+    file.read(reinterpret_cast<char*>(&m_origin), sizeof(m_origin));
+    file.read(reinterpret_cast<char*>(&m_voxelSize), sizeof(m_voxelSize));
+    file.read(reinterpret_cast<char*>(&m_numBricks), sizeof(m_numBricks));
+    file.read(reinterpret_cast<char*>(&numBricks), sizeof(numBricks));
+    file.read(reinterpret_cast<char*>(&numSamples), sizeof(numSamples));
+    if (!file || glm::any(glm::lessThanEqual(m_numBricks, glm::ivec3(0))) ||
+        numBricks != static_cast<uint64_t>(m_numBricks.x) * m_numBricks.y * m_numBricks.z ||
+        numSamples % SamplesPerBrick != 0)
+    {
+        m_brickIndex.clear();
+        return false;
+    }
+
+    m_brickIndex.resize(numBricks);
+    m_coarse.resize(numBricks);
+    m_samples.resize(numSamples);
+    file.read(reinterpret_cast<char*>(m_brickIndex.data()), numBricks * sizeof(int));
+    file.read(reinterpret_cast<char*>(m_coarse.data()), numBricks * sizeof(glm::vec4));
+    file.read(reinterpret_cast<char*>(m_samples.data()), numSamples * sizeof(float));
+    if (!file)
+    {
+        m_brickIndex.clear();
+        return false;
+    }
+
+    // every allocated brick must have its samples in the file
+    const uint64_t numAllocated = numSamples / SamplesPerBrick;
+    for (int index : m_brickIndex)
+    {
+        if (index < -1 || (index >= 0 && static_cast<uint64_t>(index) >= numAllocated))
+        {
+            m_brickIndex.clear();
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "TriangleBVH.hpp"
+
+// Sparse signed distance field baked from a closed triangle mesh. The domain is
+// split into bricks of BrickSize^3 voxels; only bricks near the surface store
+// samples, the rest keep the distance and gradient at their centre and are
+// extrapolated linearly. Lookups are a trilinear interpolation plus its analytic
+// gradient.
+class SignedDistanceField
+{
+public:
+    static constexpr int BrickSize = 8;
+
+    SignedDistanceField() = default;
+
+    void bake(const TriangleBVH& bvh, float voxelSize);
+    bool save(const std::string& path, uint64_t key) const;
+    bool load(const std::string& path, uint64_t key);
+
+    // identifies a bake by the object-local mesh, the scale it is baked at
+    // and the resolution, so posed copies of one mesh share a key
+    static uint64_t calculateKey(
+        const std::vector<glm::vec3>& localPositions,
+        const std::vector<Triangle>& triangles,
+        const glm::vec3& scale,
+        float voxelSize
+    );
+
+    bool empty() const { return m_brickIndex.empty(); }
+    float sample(const glm::vec3& p, glm::vec3& gradient) const;
+
+    size_t getNumBricks() const { return m_brickIndex.size(); }
+    size_t getNumAllocatedBricks() const { return m_samples.size() / SamplesPerBrick; }
+    float getVoxelSize() const { return m_voxelSize; }
+
+private:
+    static constexpr int SamplesPerAxis = BrickSize + 1;
+    static constexpr int SamplesPerBrick = SamplesPerAxis * SamplesPerAxis * SamplesPerAxis;
+
+    size_t getBrick(const glm::ivec3& brick) const;
+    glm::vec3 getBrickCentre(const glm::ivec3& brick) const;
+
+private:
+    glm::vec3 m_origin = glm::vec3(0.0f);
+    float m_voxelSize = 0.0f;
+    glm::ivec3 m_numBricks = glm::ivec3(0);
+
+    std::vector<int> m_brickIndex;       // -1 for bricks away from the surface
+    std::vector<glm::vec4> m_coarse;     // distance and gradient at every brick centre
+    std::vector<float> m_samples;        // SamplesPerBrick per allocated brick
+};
@@ -0,0 +1,127 @@
+#include "SpatialHash.hpp"
+
+SpatialHash::SpatialHash(float cellSize)
+    : m_cellSize(cellSize),
+      m_invCellSize(1.0f / cellSize)
+{
+}
+
+void SpatialHash::clear()
+{
+    m_colliders.clear();
+    m_faces.clear();
+    m_faceMin.clear();
+    m_faceMax.clear();
+    m_tableSize = 0;
+    m_bucketStart.clear();
+    m_entries.clear();
+}
+
+unsigned int SpatialHash::addCollider(
+    const Mesh* mesh,
+    const std::vector<glm::vec3>& positions,
+    const std::vector<Triangle>& triangles
+)
+{
+    unsigned int collider = static_cast<unsigned int>(m_colliders.size());
+    m_colliders.push_back(mesh);
+
+    for (unsigned int t = 0; t < triangles.size(); ++t)
+    {
+        const glm::vec3& a = positions[triangles[t].v1];
+        const glm::vec3& b = positions[triangles[t].v2];
+        const glm::vec3& c = positions[triangles[t].v3];
+
+        m_faces.push_back({ collider, t });
+        m_faceMin.push_back(glm::min(a, glm::min(b, c)));
+        m_faceMax.push_back(glm::max(a, glm::max(b, c)));
+    }
+
+    return collider;
+}
+
+void SpatialHash::build()
+{
+    // count cell entries first to size the table
+    size_t numEntries = 0;
+    for (size_t f = 0; f < m_faces.size(); ++f)
+    {
+        glm::ivec3 cells = getCell(m_faceMax[f]) - getCell(m_faceMin[f]) + 1;
+        numEntries += static_cast<size_t>(cells.x) * cells.y * cells.z;
+    }
+
+    m_tableSize = 1;
+    while (m_tableSize < 2 * numEntries) m_tableSize <<= 1;
+
+    // counting sort by bucket
+    m_bucketStart.assign(m_tableSize + 1, 0);
+    for (size_t f = 0; f < m_faces.size(); ++f)
+    {
+        forEachCell(m_faceMin[f], m_faceMax[f], [&](size_t bucket) {
+            m_bucketStart[bucket + 1]++;
+        });
+    }
+
+    for (size_t b = 0; b < m_tableSize; ++b)
+    {
+        m_bucketStart[b + 1] += m_bucketStart[b];
+    }
+
+    m_entries.assign(numEntries, 0);
+    std::vector<unsigned int> fill(m_bucketStart.begin(), m_bucketStart.end() - 1);
+    for (size_t f = 0; f < m_faces.size(); ++f)
+    {
+        forEachCell(m_faceMin[f], m_faceMax[f], [&](size_t bucket) {
+            m_entries[fill[bucket]++] = static_cast<unsigned int>(f);
+        });
+    }
+
+    std::cout << "SpatialHash built: " << m_faces.size() << " triangles, "
+              << numEntries << " cell entries, " << m_tableSize << " buckets\n";
+}
+
+int SpatialHash::getColliderIndex(const Mesh* mesh) const
+{
+    auto it = std::find(m_colliders.begin(), m_colliders.end(), mesh);
+    return it == m_colliders.end() ? -1 : static_cast<int>(it - m_colliders.begin());
+}
+
+void SpatialHash::query(const glm::vec3& min, const glm::vec3& max, std::vector<Entry>& hits) const
+{
+    hits.clear();
+    if (empty()) return;
+
+    std::vector<unsigned int> faces;
+    forEachCell(min, max, [&](size_t bucket) {
+        for (unsigned int i = m_bucketStart[bucket]; i < m_bucketStart[bucket + 1]; ++i)
+        {
+            // different cells can share a bucket, so check the actual bounds
+            unsigned int f = m_entries[i];
+            if (glm::all(glm::lessThanEqual(m_faceMin[f], max)) &&
+                glm::all(glm::greaterThanEqual(m_faceMax[f], min)))
+            {
+                faces.push_back(f);
+            }
+        }
+    });
+
+    std::sort(faces.begin(), faces.end());
+    faces.erase(std::unique(faces.begin(), faces.end()), faces.end());
+    for (unsigned int f : faces)
+    {
+        hits.push_back(m_faces[f]);
+    }
+}
+
+glm::ivec3 SpatialHash::getCell(const glm::vec3& p) const
+{
+    return glm::ivec3(glm::floor(p * m_invCellSize));
+}
+
+size_t SpatialHash::hashCell(int x, int y, int z) const
+{
+    uint32_t h = (static_cast<uint32_t>(x) * 73856093u) ^
+                 (static_cast<uint32_t>(y) * 19349663u) ^
+                 (static_cast<uint32_t>(z) * 83492791u);
+    return h & (m_tableSize - 1);
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "Mesh.hpp"
+
+// Uniform spatial hash over the triangles of static colliders (Teschner et al.
+// 2003). Every triangle is entered into each cell its bounding box overlaps and
+// the entries are counting-sorted by bucket into one flat array, so a query only
+// touches the buckets of the cells it overlaps.
+class SpatialHash
+{
+public:
+    struct Entry
+    {
+        unsigned int collider;
+        unsigned int triangle;
+    };
+
+    explicit SpatialHash(float cellSize = 1.0f);
+
+    void clear();
+    unsigned int addCollider(
+        const Mesh* mesh,
+        const std::vector<glm::vec3>& positions,
+        const std::vector<Triangle>& triangles
+    );
+    void build();
+
+    bool empty() const { return m_entries.empty(); }
+    size_t getNumColliders() const { return m_colliders.size(); }
+    size_t getNumEntries() const { return m_entries.size(); }
+    float getCellSize() const { return m_cellSize; }
+    int getColliderIndex(const Mesh* mesh) const;
+
+    // triangles whose bounds overlap the box, each reported once
+    void query(const glm::vec3& min, const glm::vec3& max, std::vector<Entry>& hits) const;
+
+private:
+    glm::ivec3 getCell(const glm::vec3& p) const;
+    size_t hashCell(int x, int y, int z) const;
+
+    template<typename Visit>
+    void forEachCell(const glm::vec3& min, const glm::vec3& max, Visit visit) const
+    {
+        glm::ivec3 lo = getCell(min);
+        glm::ivec3 hi = getCell(max);
+        for (int x = lo.x; x <= hi.x; ++x)
+            for (int y = lo.y; y <= hi.y; ++y)
+                for (int z = lo.z; z <= hi.z; ++z)
+                    visit(hashCell(x, y, z));
+    }
+
+private:
+    float m_cellSize;
+    float m_invCellSize;
+
+    std::vector<const Mesh*> m_colliders;
+    std::vector<Entry> m_faces;
+    std::vector<glm::vec3> m_faceMin;
+    std::vector<glm::vec3> m_faceMax;
+
+    // bucket b holds m_entries[m_bucketStart[b] .. m_bucketStart[b + 1])
+    size_t m_tableSize = 0;
+    std::vector<unsigned int> m_bucketStart;
+    std::vector<unsigned int> m_entries;
+};
@@ -0,0 +1,490 @@
+#include "TriangleBVH.hpp"
+
+#include <algorithm>
+#include <map>
+
+static glm::vec3 closestPointOnTriangle(
+    const glm::vec3& p,
+    const glm::vec3& a,
+    const glm::vec3& b,
+    const glm::vec3& c,
+    int& feature
+)
+{
+    // Voronoi regions of Ericson's Real-Time Collision Detection 5.1.5;
+    // feature 0-2 are the vertices, 3-5 the edges ab, bc, ca and 6 the face
+    glm::vec3 ab = b - a;
+    glm::vec3 ac = c - a;
+    glm::vec3 ap = p - a;
+    float d1 = glm::dot(ab, ap);
+    float d2 = glm::dot(ac, ap);
+    if (d1 <= 0.0f && d2 <= 0.0f)
+    {
+        feature = 0;
+        return a;
+    }
+
+    glm::vec3 bp = p - b;
+    float d3 = glm::dot(ab, bp);
+    float d4 = glm::dot(ac, bp);
+    if (d3 >= 0.0f && d4 <= d3)
+    {
+        feature = 1;
+        return b;
+    }
+
+    float vc = d1 * d4 - d3 * d2;
+    if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f)
+    {
+        feature = 3;
+        return a + (d1 / (d1 - d3)) * ab;
+    }
+
+    glm::vec3 cp = p - c;
+    float d5 = glm::dot(ab, cp);
+    float d6 = glm::dot(ac, cp);
+    if (d6 >= 0.0f && d5 <= d6)
+    {
+        feature = 2;
+        return c;
+    }
+
+    float vb = d5 * d2 - d1 * d6;
+    if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f)
+    {
+        feature = 5;
+        return a + (d2 / (d2 - d6)) * ac;
+    }
+
+    float va = d3 * d6 - d5 * d4;
+    if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f)
+    {
+        feature = 4;
+        return b + ((d4 - d3) / ((d4 - d3) + (d5 - d6))) * (c - b);
+    }
+
+    feature = 6;
+    float denominator = 1.0f / (va + vb + vc);
+    return a + ab * (vb * denominator) + ac * (vc * denominator);
+}
+
+TriangleBVH::TriangleBVH(const std::vector<glm::vec3>& positions, const std::vector<Triangle>& triangles)
+    : m_positions(positions),
+      m_triangles(triangles)
+{
+    if (m_triangles.empty()) return;
+
+    m_centroids.reserve(m_triangles.size());
+    m_order.reserve(m_triangles.size());
+    for (unsigned int t = 0; t < m_triangles.size(); ++t)
+    {
+        const Triangle& tri = m_triangles[t];
+        m_centroids.push_back((m_positions[tri.v1] + m_positions[tri.v2] + m_positions[tri.v3]) / 3.0f);
+        m_order.push_back(t);
+    }
+
+    m_nodes.reserve(2 * m_triangles.size());
+    m_nodes.push_back({});
+    buildNode(0, 0, static_cast<unsigned int>(m_triangles.size()), 0);
+
+    // leaves index triangles directly
+    std::vector<Triangle> ordered;
+    for (unsigned int t : m_order)
+    {
+        ordered.push_back(m_triangles[t]);
+    }
+    m_triangles = std::move(ordered);
+    m_centroids.clear();
+
+    buildEdgeIndices();
+    calculatePseudoNormals();
+}
+
+void TriangleBVH::buildEdgeIndices()
+{
+    std::map<std::pair<unsigned int, unsigned int>, unsigned int> edges;
+    m_edgeIndices.resize(m_triangles.size());
+    for (size_t t = 0; t < m_triangles.size(); ++t)
+    {
+        const unsigned int v[3] = { m_triangles[t].v1, m_triangles[t].v2, m_triangles[t].v3 };
+        for (int k = 0; k < 3; ++k)
+        {
+            unsigned int a = v[k];
+            unsigned int b = v[(k + 1) % 3];
+            auto key = std::make_pair(std::min(a, b), std::max(a, b));
+            auto it = edges.emplace(key, static_cast<unsigned int>(edges.size())).first;
+            m_edgeIndices[t][k] = it->second;
+        }
+    }
+    m_edgeNormalSums.resize(edges.size());
+}
+
+void TriangleBVH::refit(const std::vector<glm::vec3>& positions)
+{
+    if (empty()) return;
+
+    m_positions = positions;
+    calculatePseudoNormals();
+
+    // children are always stored after their parent
+    for (size_t i = m_nodes.size(); i-- > 0;)
+    {
+        Node& node = m_nodes[i];
+        if (node.count == 0)
+        {
+            const Node& left = m_nodes[node.start];
+            const Node& right = m_nodes[node.start + 1];
+            node.min = glm::min(left.min, right.min);
+            node.max = glm::max(left.max, right.max);
+            continue;
+        }
+
+        node.min = glm::vec3(std::numeric_limits<float>::max());
+        node.max = glm::vec3(-std::numeric_limits<float>::max());
+        for (unsigned int t = node.start; t < node.start + node.count; ++t)
+        {
+            const Triangle& tri = m_triangles[t];
+            for (unsigned int v : { tri.v1, tri.v2, tri.v3 })
+            {
+                node.min = glm::min(node.min, m_positions[v]);
+                node.max = glm::max(node.max, m_positions[v]);
+            }
+        }
+    }
+}
+
+void TriangleBVH::calculatePseudoNormals()
+{
+    m_faceNormals.resize(m_triangles.size());
+    m_edgeNormals.resize(m_triangles.size());
+    m_vertexNormals.assign(m_positions.size(), glm::vec3(0.0f));
+    std::fill(m_edgeNormalSums.begin(), m_edgeNormalSums.end(), glm::vec3(0.0f));
+
+    for (size_t t = 0; t < m_triangles.size(); ++t)
+    {
+        const unsigned int v[3] = { m_triangles[t].v1, m_triangles[t].v2, m_triangles[t].v3 };
+        // degenerate triangles of a squashed mesh contribute nothing
+        glm::vec3 c = glm::cross(m_positions[v[1]] - m_positions[v[0]], m_positions[v[2]] - m_positions[v[0]]);
+        float area2 = glm::dot(c, c);
+        glm::vec3 n = area2 > 0.0f ? c / std::sqrt(area2) : glm::vec3(0.0f);
+        m_faceNormals[t] = n;
+        if (area2 == 0.0f) continue;
+
+        for (int k = 0; k < 3; ++k)
+        {
+            // vertices are weighted by their incident angle
+            glm::vec3 e1 = glm::normalize(m_positions[v[(k + 1) % 3]] - m_positions[v[k]]);
+            glm::vec3 e2 = glm::normalize(m_positions[v[(k + 2) % 3]] - m_positions[v[k]]);
+            float angle = std::acos(glm::clamp(glm::dot(e1, e2), -1.0f, 1.0f));
+            m_vertexNormals[v[k]] += angle * n;
+
+            m_edgeNormalSums[m_edgeIndices[t][k]] += n;
+        }
+    }
+
+    for (auto& n : m_vertexNormals)
+    {
+        if (glm::dot(n, n) > 0.0f) n = glm::normalize(n);
+    }
+
+    for (size_t t = 0; t < m_triangles.size(); ++t)
+    {
+        for (int k = 0; k < 3; ++k)
+        {
+            glm::vec3 n = m_edgeNormalSums[m_edgeIndices[t][k]];
+            m_edgeNormals[t][k] = glm::dot(n, n) > 0.0f ? glm::normalize(n) : n;
+        }
+    }
+}
+
+float TriangleBVH::calculateSurfaceArea(const glm::vec3& min, const glm::vec3& max)
+{
+    glm::vec3 e = max - min;
+    return 2.0f * (e.x * e.y + e.y * e.z + e.z * e.x);
+}
+
+unsigned int TriangleBVH::buildNode(unsigned int nodeIndex, unsigned int start, unsigned int count, int depth)
+{
+    glm::vec3 min(std::numeric_limits<float>::max());
+    glm::vec3 max(-std::numeric_limits<float>::max());
+    glm::vec3 centroidMin = min;
+    glm::vec3 centroidMax = max;
+    for (unsigned int i = start; i < start + count; ++i)
+    {
+        const Triangle& tri = m_triangles[m_order[i]];
+        for (unsigned int v : { tri.v1, tri.v2, tri.v3 })
+        {
+            min = glm::min(min, m_positions[v]);
+            max = glm::max(max, m_positions[v]);
+        }
+        centroidMin = glm::min(centroidMin, m_centroids[m_order[i]]);
+        centroidMax = glm::max(centroidMax, m_centroids[m_order[i]]);
+    }
+
+    m_nodes[nodeIndex] = { min, max, start, count };
+
+    const unsigned int maxLeafSize = 4;
+    if (count <= maxLeafSize || depth >= MaxDepth) return nodeIndex;
+
+    // binned SAH over all three axes
+    constexpr int numBins = 12;
+    float bestCost = std::numeric_limits<float>::max();
+    int bestAxis = -1;
+    int bestSplit = 0;
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        float extent = centroidMax[axis] - centroidMin[axis];
+        if (extent <= 0.0f) continue;
+
+        struct Bin
+        {
+            glm::vec3 min = glm::vec3(std::numeric_limits<float>::max());
+            glm::vec3 max = glm::vec3(-std::numeric_limits<float>::max());
+            unsigned int count = 0;
+        };
+        Bin bins[numBins];
+
+        float scale = numBins / extent;
+        for (unsigned int i = start; i < start + count; ++i)
+        {
+            unsigned int t = m_order[i];
+            int b = std::min(numBins - 1, static_cast<int>((m_centroids[t][axis] - centroidMin[axis]) * scale));
+            const Triangle& tri = m_triangles[t];
+            for (unsigned int v : { tri.v1, tri.v2, tri.v3 })
+            {
+                bins[b].min = glm::min(bins[b].min, m_positions[v]);
+                bins[b].max = glm::max(bins[b].max, m_positions[v]);
+            }
+            bins[b].count++;
+        }
+
+        // sweep from the right to get the cost of every split plane
+        float rightArea[numBins];
+        unsigned int rightCount[numBins];
+        Bin right;
+        for (int b = numBins - 1; b > 0; --b)
+        {
+            right.min = glm::min(right.min, bins[b].min);
+            right.max = glm::max(right.max, bins[b].max);
+            right.count += bins[b].count;
+            rightArea[b] = right.count ? calculateSurfaceArea(right.min, right.max) : 0.0f;
+            rightCount[b] = right.count;
+        }
+
+        Bin left;
+        for (int b = 0; b < numBins - 1; ++b)
+        {
+            left.min = glm::min(left.min, bins[b].min);
+            left.max = glm::max(left.max, bins[b].max);
+            left.count += bins[b].count;
+            if (left.count == 0 || rightCount[b + 1] == 0) continue;
+
+            float cost = left.count * calculateSurfaceArea(left.min, left.max) + rightCount[b + 1] * rightArea[b + 1];
+            if (cost < bestCost)
+            {
+                bestCost = cost;
+                bestAxis = axis;
+                bestSplit = b;
+            }
+        }
+    }
+
+    // splitting must beat intersecting every triangle of the node
+    if (bestAxis < 0 || bestCost >= count * calculateSurfaceArea(min, max)) return nodeIndex;
+
+    float scale = numBins / (centroidMax[bestAxis] - centroidMin[bestAxis]);
+    auto middle = std::partition(m_order.begin() + start, m_order.begin() + start + count, [&](unsigned int t) {
+        int b = std::min(numBins - 1, static_cast<int>((m_centroids[t][bestAxis] - centroidMin[bestAxis]) * scale));
+        return b <= bestSplit;
+    });
+    unsigned int leftCount = static_cast<unsigned int>(middle - (m_order.begin() + start));
+    if (leftCount == 0 || leftCount == count) return nodeIndex;
+
+    // children are stored next to each other
+    unsigned int left = static_cast<unsigned int>(m_nodes.size());
+    m_nodes.push_back({});
+    m_nodes.push_back({});
+    m_nodes[nodeIndex].start = left;
+    m_nodes[nodeIndex].count = 0;
+    buildNode(left, start, leftCount, depth + 1);
+    buildNode(left + 1, start + leftCount, count - leftCount, depth + 1);
+    return nodeIndex;
+}
+
+float TriangleBVH::calculateBoxDistance2(const glm::vec3& p, const glm::vec3& min, const glm::vec3& max)
+{
+    glm::vec3 d = glm::max(glm::max(min - p, p - max), glm::vec3(0.0f));
+    return glm::dot(d, d);
+}
+
+bool TriangleBVH::findClosestPoint(const glm::vec3& p, ClosestPoint& result, float maxDistance) const
+{
+    if (empty()) return false;
+
+    float best2 = maxDistance < std::numeric_limits<float>::max() ? maxDistance * maxDistance : maxDistance;
+    int bestFeature = -1;
+    unsigned int bestTriangle = 0;
+    glm::vec3 bestPoint(0.0f);
+
+    unsigned int stack[MaxDepth + 2];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0)
+    {
+        const Node& node = m_nodes[stack[--top]];
+        if (calculateBoxDistance2(p, node.min, node.max) >= best2) continue;
+
+        if (node.count > 0)
+        {
+            for (unsigned int t = node.start; t < node.start + node.count; ++t)
+            {
+                const Triangle& tri = m_triangles[t];
+                int feature;
+                glm::vec3 q = closestPointOnTriangle(p, m_positions[tri.v1], m_positions[tri.v2], m_positions[tri.v3], feature);
+                float d2 = glm::dot(p - q, p - q);
+                if (d2 < best2)
+                {
+                    best2 = d2;
+                    bestFeature = feature;
+                    bestTriangle = t;
+                    bestPoint = q;
+                }
+            }
+            continue;
+        }
+
+        // nearer child on top of the stack
+        unsigned int near = node.start;
+        unsigned int far = node.start + 1;
+        float dNear = calculateBoxDistance2(p, m_nodes[near].min, m_nodes[near].max);
+        float dFar = calculateBoxDistance2(p, m_nodes[far].min, m_nodes[far].max);
+        if (dFar < dNear)
+        {
+            std::swap(near, far);
+            std::swap(dNear, dFar);
+        }
+        if (dFar < best2) stack[top++] = far;
+        if (dNear < best2) stack[top++] = near;
+    }
+
+    if (bestFeature < 0) return false;
+
+    const Triangle& tri = m_triangles[bestTriangle];
+    glm::vec3 normal;
+    if (bestFeature < 3)
+    {
+        const unsigned int v[3] = { tri.v1, tri.v2, tri.v3 };
+        normal = m_vertexNormals[v[bestFeature]];
+    }
+    else if (bestFeature < 6)
+    {
+        normal = m_edgeNormals[bestTriangle][bestFeature - 3];
+    }
+    else
+    {
+        normal = m_faceNormals[bestTriangle];
+    }
+
+    float distance = std::sqrt(best2);
+    result.point = bestPoint;
+    result.normal = normal;
+    result.distance = glm::dot(p - bestPoint, normal) < 0.0f ? -distance : distance;
+    result.triangle = m_order[bestTriangle];
+    return true;
+}
+
+float TriangleBVH::calculateSignedDistance(const glm::vec3& p) const
+{
+    ClosestPoint closest;
+    if (!findClosestPoint(p, closest)) return std::numeric_limits<float>::max();
+    return closest.distance;
+}
+
+bool TriangleBVH::findContact(const glm::vec3& p, glm::vec3& normal, float& depth) const
+{
+    // a point outside the bounds cannot be inside
+    if (empty() || calculateBoxDistance2(p, getMin(), getMax()) > 0.0f) return false;
+
+    ClosestPoint closest;
+    if (!findClosestPoint(p, closest) || closest.distance >= 0.0f) return false;
+
+    depth = -closest.distance;
+    normal = depth > 1e-6f ? (closest.point - p) / depth : closest.normal;
+    return true;
+}
+
+bool TriangleBVH::raycast(const glm::vec3& origin, const glm::vec3& direction, float maxT, RayHit& hit) const
+{
+    if (empty()) return false;
+
+    glm::vec3 invDirection = 1.0f / direction;
+    auto intersectBox = [&](const Node& node, float tMax) {
+        glm::vec3 t0 = (node.min - origin) * invDirection;
+        glm::vec3 t1 = (node.max - origin) * invDirection;
+        glm::vec3 tNear = glm::min(t0, t1);
+        glm::vec3 tFar = glm::max(t0, t1);
+        float enter = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.0f));
+        float exit = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, tMax));
+        return enter <= exit ? enter : std::numeric_limits<float>::max();
+    };
+
+    bool found = false;
+    float bestT = maxT;
+    unsigned int stack[MaxDepth + 2];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0)
+    {
+        const Node& node = m_nodes[stack[--top]];
+        if (intersectBox(node, bestT) == std::numeric_limits<float>::max()) continue;
+
+        if (node.count > 0)
+        {
+            for (unsigned int t = node.start; t < node.start + node.count; ++t)
+            {
+                // Moeller-Trumbore
+                const Triangle& tri = m_triangles[t];
+                const glm::vec3& a = m_positions[tri.v1];
+                glm::vec3 e1 = m_positions[tri.v2] - a;
+                glm::vec3 e2 = m_positions[tri.v3] - a;
+                glm::vec3 pv = glm::cross(direction, e2);
+                float det = glm::dot(e1, pv);
+                if (std::abs(det) < 1e-12f) continue;
+
+                float invDet = 1.0f / det;
+                glm::vec3 tv = origin - a;
+                float u = glm::dot(tv, pv) * invDet;
+                if (u < 0.0f || u > 1.0f) continue;
+
+                glm::vec3 qv = glm::cross(tv, e1);
+                float v = glm::dot(direction, qv) * invDet;
+                if (v < 0.0f || u + v > 1.0f) continue;
+
+                float tHit = glm::dot(e2, qv) * invDet;
+                if (tHit < 0.0f || tHit >= bestT) continue;
+
+                bestT = tHit;
+                hit.t = tHit;
+                hit.point = origin + tHit * direction;
+                hit.normal = m_faceNormals[t];
+                hit.triangle = m_order[t];
+                found = true;
+            }
+            continue;
+        }
+
+        unsigned int near = node.start;
+        unsigned int far = node.start + 1;
+        float tNear = intersectBox(m_nodes[near], bestT);
+        float tFar = intersectBox(m_nodes[far], bestT);
+        if (tFar < tNear)
+        {
+            std::swap(near, far);
+            std::swap(tNear, tFar);
+        }
+        if (tFar != std::numeric_limits<float>::max()) stack[top++] = far;
+        if (tNear != std::numeric_limits<float>::max()) stack[top++] = near;
+    }
+
+    return found;
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <array>
+#include <limits>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "Mesh.hpp"
+
+// Bounding volume hierarchy over the triangles of a collider, built with the
+// binned surface area heuristic. Deforming meshes keep the tree and refit it.
+// Signs come from angle-weighted pseudo-normals (Baerentzen & Aanaes 2005), so
+// the mesh must be closed and consistently wound, but it need not be convex.
+class TriangleBVH
+{
+public:
+    struct ClosestPoint
+    {
+        glm::vec3 point;
+        glm::vec3 normal;   // pseudo-normal of the closest feature
+        float distance;     // signed, negative inside
+        unsigned int triangle;
+    };
+
+    struct RayHit
+    {
+        glm::vec3 point;
+        glm::vec3 normal;
+        float t;
+        unsigned int triangle;
+    };
+
+    TriangleBVH() = default;
+    TriangleBVH(const std::vector<glm::vec3>& positions, const std::vector<Triangle>& triangles);
+
+    // new vertex positions for the same triangles; bounds and pseudo-normals
+    // are updated, the topology of the tree is kept
+    void refit(const std::vector<glm::vec3>& positions);
+
+    bool empty() const { return m_nodes.empty(); }
+    size_t getNumNodes() const { return m_nodes.size(); }
+    const glm::vec3& getMin() const { return m_nodes[0].min; }
+    const glm::vec3& getMax() const { return m_nodes[0].max; }
+    const std::vector<glm::vec3>& getPositions() const { return m_positions; }
+    const std::vector<Triangle>& getTriangles() const { return m_triangles; }
+
+    bool findClosestPoint(
+        const glm::vec3& p,
+        ClosestPoint& result,
+        float maxDistance = std::numeric_limits<float>::max()
+    ) const;
+    float calculateSignedDistance(const glm::vec3& p) const;
+    bool raycast(
+        const glm::vec3& origin,
+        const glm::vec3& direction,
+        float maxT,
+        RayHit& hit
+    ) const;
+
+    // penetration of a point that lies inside the collider
+    bool findContact(const glm::vec3& p, glm::vec3& normal, float& depth) const;
+
+private:
+    // bounds the traversal stacks
+    static constexpr int MaxDepth = 62;
+
+    struct Node
+    {
+        glm::vec3 min;
+        glm::vec3 max;
+        unsigned int start;   // first child for inner nodes, first triangle for leaves
+        unsigned int count;   // 0 for inner nodes
+    };
+
+    void buildEdgeIndices();
+    void calculatePseudoNormals();
+    unsigned int buildNode(unsigned int nodeIndex, unsigned int start, unsigned int count, int depth);
+    static float calculateBoxDistance2(const glm::vec3& p, const glm::vec3& min, const glm::vec3& max);
+    static float calculateSurfaceArea(const glm::vec3& min, const glm::vec3& max);
+
+private:
+    std::vector<glm::vec3> m_positions;
+    std::vector<Triangle> m_triangles;
+    std::vector<glm::vec3> m_centroids;
+    std::vector<unsigned int> m_order;     // leaf order -> input triangle
+    std::vector<Node> m_nodes;
+
+    std::vector<glm::vec3> m_faceNormals;
+    std::vector<std::array<glm::vec3, 3>> m_edgeNormals;   // edges v1v2, v2v3, v3v1
+    std::vector<glm::vec3> m_vertexNormals;
+
+    // per triangle, its edges' slots in m_edgeNormalSums; built once, since
+    // refits keep the triangles
+    std::vector<std::array<unsigned int, 3>> m_edgeIndices;
+    std::vector<glm::vec3> m_edgeNormalSums;
+};
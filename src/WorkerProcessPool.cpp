@@ -0,0 +1,316 @@
+#include "WorkerProcessPool.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <thread>
+#include <fcntl.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+static void backoff(int& spins)
+{
+    // spin briefly, then yield, then sleep so idle workers don't burn a core
+    // while the coordinator renders
+    if (++spins < 64) return;
+    if (spins < 1024)
+    {
+        std::this_thread::yield();
+        return;
+    }
+    std::this_thread::sleep_for(std::chrono::microseconds(50));
+}
+
+void WorkerProcessPool::assignOwners(const std::vector<size_t>& slotSizes)
+{
+    // largest slots first onto the least loaded worker
+    std::vector<size_t> order(slotSizes.size());
+    for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return slotSizes[a] > slotSizes[b];
+    });
+
+    std::vector<size_t> load(m_numWorkers, 0);
+    m_owners.assign(slotSizes.size(), 0);
+    for (size_t slot : order)
+    {
+        int worker = static_cast<int>(std::min_element(load.begin(), load.end()) - load.begin());
+        m_owners[slot] = worker;
+        load[worker] += slotSizes[slot];
+    }
+}
+
+WorkerProcessPool::WorkerProcessPool(int numWorkers, const std::vector<size_t>& slotSizes)
+    : m_numWorkers(std::clamp(numWorkers, 1, MaxWorkers)),
+      m_slotSizes(slotSizes)
+{
+    assignOwners(slotSizes);
+
+    // per buffer: positions then velocities of every slot
+    size_t offset = 0;
+    for (size_t size : slotSizes)
+    {
+        m_slotOffsets.push_back(offset);
+        offset += 2 * size * sizeof(glm::vec3);
+    }
+    m_bufferSize = offset;
+
+    // header, then the slot params, then both buffers
+    size_t headerSize = (sizeof(Header) + 63) & ~size_t(63);
+    m_slotParamsSize = (slotSizes.size() * sizeof(SlotParams) + 63) & ~size_t(63);
+    m_memorySize = headerSize + m_slotParamsSize + 2 * m_bufferSize;
+
+    std::string name = "/xpbd-softbody-" + std::to_string(getpid());
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0)
+    {
+        std::cerr << "WorkerProcessPool: shm_open failed: " << std::strerror(errno) << std::endl;
+        return;
+    }
+
+    if (ftruncate(fd, static_cast<off_t>(m_memorySize)) != 0)
+    {
+        std::cerr << "WorkerProcessPool: ftruncate failed: " << std::strerror(errno) << std::endl;
+        close(fd);
+        shm_unlink(name.c_str());
+        return;
+    }
+
+    void* memory = mmap(nullptr, m_memorySize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+
+    // forked workers inherit the mapping, so the name is not needed any more and
+    // nothing is left behind in /dev/shm if a process dies
+    shm_unlink(name.c_str());
+
+    if (memory == MAP_FAILED)
+    {
+        std::cerr << "WorkerProcessPool: mmap failed: " << std::strerror(errno) << std::endl;
+        return;
+    }
+
+    m_memory = memory;
+    m_header = new (m_memory) Header();
+    m_header->frameSeq.store(0, std::memory_order_relaxed);
+    m_header->quit.store(0, std::memory_order_relaxed);
+    m_header->fieldsDone.store(0, std::memory_order_relaxed);
+    for (auto& counter : m_header->doneSeq)
+    {
+        counter.value.store(0, std::memory_order_relaxed);
+    }
+    for (size_t slot = 0; slot < slotSizes.size(); ++slot)
+    {
+        new (&getSlotParams(slot)) SlotParams{ false };
+    }
+}
+
+WorkerProcessPool::~WorkerProcessPool()
+{
+    if (m_isCoordinator)
+    {
+        shutdown();
+    }
+}
+
+WorkerProcessPool::ParticleState WorkerProcessPool::getState(size_t slot, uint64_t seq)
+{
+    size_t headerSize = (sizeof(Header) + 63) & ~size_t(63);
+    char* buffer = static_cast<char*>(m_memory) + headerSize + m_slotParamsSize + (seq & 1) * m_bufferSize;
+    glm::vec3* positions = reinterpret_cast<glm::vec3*>(buffer + m_slotOffsets[slot]);
+    return { positions, positions + m_slotSizes[slot], m_slotSizes[slot] };
+}
+
+WorkerProcessPool::SlotParams& WorkerProcessPool::getSlotParams(size_t slot)
+{
+    size_t headerSize = (sizeof(Header) + 63) & ~size_t(63);
+    return reinterpret_cast<SlotParams*>(static_cast<char*>(m_memory) + headerSize)[slot];
+}
+
+std::vector<std::vector<int>> WorkerProcessPool::readNumaNodeCpus()
+{
+    namespace fs = std::filesystem;
+    std::vector<std::vector<int>> nodes;
+
+    std::error_code ec;
+    const fs::path root("/sys/devices/system/node");
+    for (int node = 0; fs::exists(root / ("node" + std::to_string(node)), ec); ++node)
+    {
+        std::ifstream file(root / ("node" + std::to_string(node)) / "cpulist");
+        std::string list;
+        std::getline(file, list);
+
+        // e.g. "0-15,32-47"
+        std::vector<int> cpus;
+        std::stringstream ranges(list);
+        std::string range;
+        while (std::getline(ranges, range, ','))
+        {
+            if (range.empty()) continue;
+            size_t dash = range.find('-');
+            int first = std::stoi(range.substr(0, dash));
+            int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+            for (int cpu = first; cpu <= last; ++cpu) cpus.push_back(cpu);
+        }
+
+        if (!cpus.empty()) nodes.push_back(std::move(cpus));
+    }
+
+    return nodes;
+}
+
+void WorkerProcessPool::pinToNumaNode(int worker)
+{
+    // one worker process per NUMA node, round-robin when there are more workers
+    std::vector<std::vector<int>> nodes = readNumaNodeCpus();
+    if (nodes.size() < 2) return;
+
+    const auto& cpus = nodes[worker % nodes.size()];
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus)
+    {
+        if (cpu < CPU_SETSIZE) CPU_SET(cpu, &set);
+    }
+
+    if (sched_setaffinity(0, sizeof(set), &set) != 0)
+    {
+        std::cerr << "WorkerProcessPool: could not pin worker " << worker << " to NUMA node" << std::endl;
+    }
+}
+
+bool WorkerProcessPool::launch(const std::function<void(int)>& workerMain)
+{
+    if (!isValid()) return false;
+
+    // workers start from the sequence at fork time; reading it in the child
+    // could already see the coordinator's first frame
+    m_launchSeq = getSequence();
+    m_coordinatorPid = getpid();
+
+    for (int worker = 0; worker < m_numWorkers; ++worker)
+    {
+        pid_t pid = fork();
+        if (pid < 0)
+        {
+            std::cerr << "WorkerProcessPool: fork failed: " << std::strerror(errno) << std::endl;
+            shutdown();
+            return false;
+        }
+
+        if (pid == 0)
+        {
+            // the child must never return into the render loop or run destructors
+            // that touch the GL context it shares with the parent
+            m_isCoordinator = false;
+            pinToNumaNode(worker);
+            workerMain(worker);
+            std::cout.flush();
+            _exit(0);
+        }
+
+        m_pids.push_back(pid);
+    }
+
+    std::cout << "WorkerProcessPool launched " << m_numWorkers << " worker processes.\n";
+    return true;
+}
+
+uint64_t WorkerProcessPool::getSequence() const
+{
+    return m_header->frameSeq.load(std::memory_order_acquire);
+}
+
+uint64_t WorkerProcessPool::publishFrame(const FrameParams& params)
+{
+    m_header->params = params;
+    return m_header->frameSeq.fetch_add(1, std::memory_order_acq_rel) + 1;
+}
+
+bool WorkerProcessPool::waitForWorkers(uint64_t seq)
+{
+    for (int worker = 0; worker < m_numWorkers; ++worker)
+    {
+        int spins = 0;
+        while (m_header->doneSeq[worker].value.load(std::memory_order_acquire) < seq)
+        {
+            backoff(spins);
+
+            // a worker that crashed would otherwise be waited for forever
+            if ((spins & 1023) == 0 && waitpid(m_pids[worker], nullptr, WNOHANG) != 0)
+            {
+                std::cerr << "WorkerProcessPool: worker " << worker << " exited" << std::endl;
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void WorkerProcessPool::shutdown()
+{
+    if (!isValid()) return;
+
+    if (!m_pids.empty())
+    {
+        m_header->quit.store(1, std::memory_order_release);
+        m_header->frameSeq.fetch_add(1, std::memory_order_acq_rel);
+        for (pid_t pid : m_pids)
+        {
+            waitpid(pid, nullptr, 0);
+        }
+        m_pids.clear();
+    }
+
+    munmap(m_memory, m_memorySize);
+    m_memory = nullptr;
+    m_header = nullptr;
+}
+
+bool WorkerProcessPool::waitForFrame(uint64_t& seq, FrameParams& params)
+{
+    int spins = 0;
+    uint64_t next;
+    while ((next = m_header->frameSeq.load(std::memory_order_acquire)) <= seq)
+    {
+        backoff(spins);
+
+        // don't outlive a coordinator that died without shutting us down
+        if ((spins & 1023) == 0 && getppid() != m_coordinatorPid) return false;
+    }
+
+    if (m_header->quit.load(std::memory_order_acquire)) return false;
+
+    seq = next;
+    params = m_header->params;
+    return true;
+}
+
+void WorkerProcessPool::finishFrame(int worker, uint64_t seq)
+{
+    m_header->doneSeq[worker].value.store(seq, std::memory_order_release);
+}
+
+void WorkerProcessPool::publishField()
+{
+    m_header->fieldsDone.fetch_add(1, std::memory_order_acq_rel);
+}
+
+bool WorkerProcessPool::waitForField(uint32_t field)
+{
+    int spins = 0;
+    while (m_header->fieldsDone.load(std::memory_order_acquire) <= field)
+    {
+        backoff(spins);
+
+        if (m_header->quit.load(std::memory_order_acquire)) return false;
+        if ((spins & 1023) == 0 && getppid() != m_coordinatorPid) return false;
+    }
+    return true;
+}
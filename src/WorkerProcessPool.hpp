@@ -0,0 +1,134 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include <sys/types.h>
+#include <glm/glm.hpp>
+
+// Runs parts of a scene in forked local worker processes. Every dynamic object
+// gets a slot in a POSIX shared-memory region holding its particle positions and
+// velocities, double-buffered by frame parity: during frame f workers read
+// buffer (f - 1) & 1 and write buffer f & 1, so nobody reads a slot while its
+// owner writes it. The coordinator drives frames in lockstep through lock-free
+// sequence counters; each worker runs all substeps of a frame on its own.
+class WorkerProcessPool
+{
+public:
+    static constexpr int MaxWorkers = 64;
+
+    struct FrameParams
+    {
+        float deltaTime;
+        int substeps;
+        glm::vec3 gravitationalAcceleration;
+        float alpha;
+        float beta;
+        float bendingAlpha;
+        float k;
+        bool enableDistanceConstraints;
+        bool enableBendingConstraints;
+        bool enableVolumeConstraints;
+        bool enableEnvCollisionConstraints;
+        bool enableEnvCollisionGrid;
+        bool enableColliderBVH;
+        bool enableColliderSDF;
+        bool enableAnalyticColliders;
+        bool enableConvexHullColliders;
+        bool enableSoftBodyCollisions;
+        bool enableContinuousCollisions;
+        bool enableContactReuse;
+        bool enableContactVelocities;
+        float friction;
+        float restitution;
+        float continuousCollisionThreshold;
+        bool enablePartitionedSolve;
+        float time;             // at the end of the frame
+        int dragSlot;           // -1 if nothing is dragged
+        unsigned int dragParticle;
+        glm::vec3 dragTarget;
+    };
+
+    // per-object settings, written by the coordinator before each frame
+    struct SlotParams
+    {
+        bool enableSelfCollision;
+    };
+
+    struct ParticleState
+    {
+        glm::vec3* positions;
+        glm::vec3* velocities;
+        size_t numParticles;
+    };
+
+    WorkerProcessPool(int numWorkers, const std::vector<size_t>& slotSizes);
+    ~WorkerProcessPool();
+
+    WorkerProcessPool(const WorkerProcessPool&) = delete;
+    WorkerProcessPool& operator=(const WorkerProcessPool&) = delete;
+
+    bool isValid() const { return m_memory != nullptr; }
+    bool isCoordinator() const { return m_isCoordinator; }
+    int getNumWorkers() const { return m_numWorkers; }
+    int getOwner(size_t slot) const { return m_owners[slot]; }
+    ParticleState getState(size_t slot, uint64_t seq);
+    SlotParams& getSlotParams(size_t slot);
+
+    // coordinator side
+    bool launch(const std::function<void(int)>& workerMain);
+    uint64_t getSequence() const;
+    uint64_t getLaunchSequence() const { return m_launchSeq; }
+    uint64_t publishFrame(const FrameParams& params);
+    // false if a worker exited before finishing the frame
+    bool waitForWorkers(uint64_t seq);
+    void shutdown();
+
+    // signed distance fields are baked by the coordinator only, in the same
+    // order in every process; workers wait for each one and load it from disk
+    void publishField();
+    // false if the coordinator is gone or shutting down
+    bool waitForField(uint32_t field);
+
+    // worker side
+    bool waitForFrame(uint64_t& seq, FrameParams& params);
+    void finishFrame(int worker, uint64_t seq);
+
+private:
+    struct alignas(64) PaddedCounter
+    {
+        std::atomic<uint64_t> value;
+    };
+
+    struct Header
+    {
+        alignas(64) std::atomic<uint64_t> frameSeq;
+        std::atomic<uint32_t> quit;
+        std::atomic<uint32_t> fieldsDone;
+        FrameParams params;
+        PaddedCounter doneSeq[MaxWorkers];
+    };
+
+    void assignOwners(const std::vector<size_t>& slotSizes);
+    static std::vector<std::vector<int>> readNumaNodeCpus();
+    static void pinToNumaNode(int worker);
+
+private:
+    int m_numWorkers;
+    bool m_isCoordinator = true;
+    std::vector<pid_t> m_pids;
+    uint64_t m_launchSeq = 0;
+    pid_t m_coordinatorPid = 0;
+
+    void* m_memory = nullptr;
+    size_t m_memorySize = 0;
+    Header* m_header = nullptr;
+
+    std::vector<int> m_owners;
+    std::vector<size_t> m_slotSizes;
+    std::vector<size_t> m_slotOffsets;
+    size_t m_slotParamsSize = 0;
+    size_t m_bufferSize = 0;
+};